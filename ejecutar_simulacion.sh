@@ -8,12 +8,21 @@
 # Uso:
 #   ./ejecutar_simulacion_1.sh run/discos/param_files/parametros_1.txt
 #
+# Para correr todos los archivos de un directorio en un solo proceso (pool de hilos):
+#   ./bin/silo_simulator --sweep run/discos/param_files
+# y para repartirlos entre varios nodos con el mismo sistema de archivos (uno por nodo):
+#   ./bin/silo_simulator --sweep run/discos/param_files --queue-dir /compartido/cola
+#
 # Parámetros soportados en el archivo:
 #   BASE_RADIUS, SIZE-RATIO, CHI, TOTAL_PARTICLES,
 #   NUM_LARGE_CIRCLES, NUM_SMALL_CIRCLES, NUM_POLYGON_PARTICLES, NUM_SIDES,
 #   CURRENT_SIM, TOTAL_SIMS, SAVE_SIM_DATA,
-#   SILO_HEIGHT, SILO_WIDTH, OUTLET_WIDTH,
-#   EXIT_CHECK_EVERY_STEPS, SAVE_FRAME_EVERY_STEPS
+#   SILO_HEIGHT, SILO_WIDTH, OUTLET_WIDTH, MAX_AVALANCHES,
+#   EXIT_CHECK_EVERY_STEPS, SAVE_FRAME_EVERY_STEPS, THREADS, PARALLEL_REPLICAS,
+#   ADAPTIVE_DT, EXIT_SENSORS, ASYNC_OUTPUT, FRAME_CODEC, FRAME_TOLERANCE,
+#   PACKING_CACHE, PACKING_SEED, FORK_DISCHARGES, SEED, PACKING_GENERATOR,
+#   ARCH_DETECTION, JAM_CONFIRM_TIME, JAM_FAST_FORWARD, ROI_HEIGHT,
+#   MULTIRATE, MULTIRATE_ZONE, REINJECT_VELOCITY
 #
 # Flags de ayuda:
 #   -h / --help            Muestra esta ayuda
@@ -65,12 +74,32 @@ ${BOLD}Archivo de parámetros (formato KEY=VALUE):${NC}
   NUM_SIDES                  Lados de los polígonos
   CURRENT_SIM                Índice de simulación inicial
   TOTAL_SIMS                 Total de simulaciones a ejecutar
-  SAVE_SIM_DATA              0/1 guardar simulation_data.csv
+  SAVE_SIM_DATA              0/1 guardar frames (simulation_data.bin)
   SILO_HEIGHT                Altura del silo
   SILO_WIDTH                 Ancho del silo
   OUTLET_WIDTH               Abertura del silo
+  MAX_AVALANCHES             Avalanchas registradas por réplica (default 50)
   EXIT_CHECK_EVERY_STEPS     Verificar salida cada N pasos (default 10)
   SAVE_FRAME_EVERY_STEPS     Guardar frames cada M pasos (default 100)
+  THREADS                    Hilos para b2World_Step (default 1)
+  PARALLEL_REPLICAS          Réplicas (TOTAL_SIMS) simultáneas (default 1)
+  SEED                       Semilla de los flujos aleatorios (default: reloj)
+  ADAPTIVE_DT                0/1 paso de tiempo adaptativo en la fase de flujo
+  EXIT_SENSORS               0/1 detectar salidas con sensores Box2D
+  ASYNC_OUTPUT               0/1 escribir archivos en un hilo aparte (default 1)
+  FRAME_CODEC                raw/delta códec de frames (default delta)
+  FRAME_TOLERANCE            Cuantización de frames relativa al radio base (default 1e-4)
+  PACKING_CACHE              Directorio de la caché de empaquetamientos sedimentados
+  PACKING_SEED               Semilla del empaquetamiento (default: índice de réplica)
+  FORK_DISCHARGES            0/1 sedimentar una vez y descargar esa foto en todas las réplicas
+  PACKING_GENERATOR          batches/deposition empaquetamiento inicial (default batches)
+  ARCH_DETECTION             contacts/raycast arco a desarmar en un atasco (default contacts)
+  JAM_CONFIRM_TIME           s sin salidas para confirmar un atasco por arco (default 0.25; 0 = 5 s)
+  JAM_FAST_FORWARD           0/1 saltar atascos con todo dormido hasta el próximo desarme (default 1)
+  ROI_HEIGHT                 Aberturas sobre el orificio por encima de las cuales se congela (default 0)
+  MULTIRATE                  k: retiene el volumen lejano k-1 de cada k pasos; validar contra 1 (default 1 = no)
+  MULTIRATE_ZONE             Alto de la zona de paso fino, en aberturas (default 6)
+  REINJECT_VELOCITY          Velocidad inicial hacia abajo de las reinyectadas (default 0)
 
 ${BOLD}Ejemplo:${NC}
   $0 run/discos/param_files/parametros_1.txt
@@ -186,9 +215,29 @@ declare -A param_map=(
   ["SILO_HEIGHT"]="--silo-height"
   ["SILO_WIDTH"]="--silo-width"
   ["OUTLET_WIDTH"]="--outlet-width"
+  ["MAX_AVALANCHES"]="--max-avalanches"
   # Nuevos (frecuencias)
   ["EXIT_CHECK_EVERY_STEPS"]="--exit-check-every"
   ["SAVE_FRAME_EVERY_STEPS"]="--save-frame-every"
+  ["THREADS"]="--threads"
+  ["PARALLEL_REPLICAS"]="--parallel-replicas"
+  ["SEED"]="--seed"
+  ["ADAPTIVE_DT"]="--adaptive-dt"
+  ["EXIT_SENSORS"]="--exit-sensors"
+  ["ASYNC_OUTPUT"]="--async-output"
+  ["FRAME_CODEC"]="--frame-codec"
+  ["FRAME_TOLERANCE"]="--frame-tolerance"
+  ["PACKING_CACHE"]="--packing-cache"
+  ["PACKING_SEED"]="--packing-seed"
+  ["FORK_DISCHARGES"]="--fork-discharges"
+  ["PACKING_GENERATOR"]="--packing-generator"
+  ["ARCH_DETECTION"]="--arch-detection"
+  ["JAM_CONFIRM_TIME"]="--jam-confirm-time"
+  ["JAM_FAST_FORWARD"]="--jam-fast-forward"
+  ["ROI_HEIGHT"]="--roi-height"
+  ["MULTIRATE"]="--multirate"
+  ["MULTIRATE_ZONE"]="--multirate-zone"
+  ["REINJECT_VELOCITY"]="--reinject-velocity"
 )
 
 # ----------------------------------------
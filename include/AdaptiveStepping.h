@@ -0,0 +1,63 @@
+// include/AdaptiveStepping.h
+
+#ifndef ADAPTIVESTEPPING_H
+#define ADAPTIVESTEPPING_H
+
+#include <vector>
+#include "box2d/box2d.h"
+#include "Constants.h"
+#include "Initialization.h"
+
+// =================================================================================================
+// CONTROLADOR DE PASO DE TIEMPO ADAPTATIVO (fase de flujo, --adaptive-dt 1)
+// =================================================================================================
+//
+// En cada paso elige dt y la cantidad de subpasos a partir de:
+//   - la velocidad máxima de las partículas (traslación + borde por rotación): el
+//     desplazamiento por subpaso no supera ADAPTIVE_CFL * radio mínimo;
+//   - la superposición máxima entre contactos (cada ADAPTIVE_OVERLAP_CHECK_EVERY pasos):
+//     si supera ADAPTIVE_MAX_OVERLAP * radio mínimo, dt se reduce a la mitad y los
+//     subpasos se duplican.
+// Sin violaciones, dt crece como mucho un factor ADAPTIVE_DT_GROWTH por paso, dentro de
+// [ADAPTIVE_DT_MIN, ADAPTIVE_DT_MAX] y subpasos en [ADAPTIVE_SUBSTEPS_MIN, ADAPTIVE_SUBSTEPS_MAX].
+// El subpaso dt/subpasos tampoco supera un subpaso de seguridad sqrt(ADAPTIVE_CFL * radio
+// mínimo / g): partiendo del reposo, la gravedad no desplaza más que el límite de velocidad en
+// un subpaso. Es mucho más largo que el del paso fijo (TIME_STEP / SUB_STEP_COUNT), así que en
+// atascos y descargas lentas los subpasos por segundo simulado bajan hasta
+// ADAPTIVE_SUBSTEPS_MIN / ADAPTIVE_DT_MAX; --max-substep lo acota más si hace falta.
+
+struct StepChoice {
+    float dt;
+    int subSteps;
+};
+
+class AdaptiveStepController {
+public:
+    /**
+     * Prepara el controlador para las partículas de la réplica (radio mínimo, subpaso de
+     * seguridad con la gravedad del mundo, buffers).
+     */
+    void reset(b2WorldId worldId, const std::vector<ParticleInfo>& particles);
+
+    /**
+     * Mide el estado actual de las partículas y devuelve el paso a usar en el próximo b2World_Step.
+     */
+    StepChoice choose(const std::vector<ParticleInfo>& particles);
+
+    float maxSpeed() const { return maxSpeed_; }
+    float maxOverlap() const { return maxOverlap_; }
+
+private:
+    float measureMaxOverlap(const std::vector<ParticleInfo>& particles);
+
+    float minRadius_ = 0.0f;
+    float maxSubStep_ = TIME_STEP / SUB_STEP_COUNT;   // subpaso de seguridad (reset)
+    float dt_ = TIME_STEP;
+    int subSteps_ = SUB_STEP_COUNT;
+    int stepsSinceOverlapScan_ = 0;
+    float maxSpeed_ = 0.0f;
+    float maxOverlap_ = 0.0f;
+    std::vector<b2ContactData> contactBuffer_;
+};
+
+#endif // ADAPTIVESTEPPING_H
@@ -0,0 +1,32 @@
+// include/ArchDetection.h
+
+#ifndef ARCHDETECTION_H
+#define ARCHDETECTION_H
+
+#include <vector>
+
+// =================================================================================================
+// DETECCIÓN DE ARCOS POR GRAFO DE CONTACTOS
+// =================================================================================================
+//
+// Un atasco lo sostiene una cadena de partículas en contacto que va de un borde del orificio
+// al otro. detectArch arma el grafo de contactos (b2Body_GetContactData) de las partículas
+// de una ventana sobre el orificio y marca las que tocan el piso en la arista izquierda o
+// derecha del orificio (x = -+OUTLET_X_HALF_WIDTH). El arco es la cadena de borde a borde de
+// menor altura máxima, la que carga el atasco: se encuentra agregando partículas de abajo
+// hacia arriba hasta que un conjunto conectado toca los dos bordes, y dentro de esa altura
+// una búsqueda en anchura elige la cadena con menos partículas.
+//
+// Cuesta O(n log n + contactos) en las partículas de la ventana y no reserva memoria en régimen.
+
+struct ArchInfo {
+    std::vector<int> particles;     // índices en particles, del apoyo izquierdo al derecho
+    float leftX  = 0.0f;            // x del centro de la partícula de apoyo izquierda
+    float rightX = 0.0f;            // x del centro de la partícula de apoyo derecha
+    float peakY  = 0.0f;            // altura máxima de los centros del arco
+};
+
+// true si hay un arco que cruza el orificio; en ese caso lo deja en arch
+bool detectArch(ArchInfo& arch);
+
+#endif // ARCHDETECTION_H
@@ -0,0 +1,154 @@
+// include/AsyncWriter.h
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =================================================================================================
+// ESCRITURA ASÍNCRONA DE ARCHIVOS (hilo escritor + cola acotada sin locks)
+// =================================================================================================
+//
+// El hilo de la réplica llena bloques de BLOCK_BYTES y los pasa, ya llenos, a un hilo escritor
+// por una cola circular SPSC (un productor, un consumidor) sin locks. El escritor hace fwrite y
+// devuelve el bloque vacío por otra cola SPSC. Hay a lo sumo MAX_BLOCKS bloques en vuelo: si el
+// disco no da abasto, el productor espera un bloque libre (contrapresión) en lugar de crecer sin
+// límite en memoria. Mientras haya bloques libres, la latencia del disco no frena b2World_Step.
+//
+// AsyncStreamBuf es el std::streambuf que ven los usuarios: se conecta a un std::ostream (o a
+// un std::ofstream existente vía rdbuf) y close() espera a que todo llegue al archivo. Los
+// errores de fwrite/fseeko/fclose ocurren en el escritor: se guarda el primero (errno) de cada
+// archivo y close() lo devuelve.
+
+// Cola circular de capacidad fija (potencia de 2) para un productor y un consumidor
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity debe ser potencia de 2");
+public:
+    bool push(const T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == Capacity) return false;
+        slots_[head & (Capacity - 1)] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(T& out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        out = slots_[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+private:
+    T slots_[Capacity];
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+class AsyncWriter {
+public:
+    static constexpr size_t BLOCK_BYTES = 256 * 1024;
+    static constexpr int    MAX_BLOCKS  = 16;          // 4 MB en vuelo como máximo
+
+    struct Block {
+        char   data[BLOCK_BYTES];
+        size_t used = 0;
+    };
+
+    AsyncWriter();
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    // Lado productor (hilo de la réplica)
+    Block* acquireBlock();                                     // espera si no hay bloques libres
+    // error: primer errno del archivo (0 = sin errores), lo completa el escritor
+    void   submitWrite(std::FILE* file, Block* block, std::atomic<int>* error);
+    void   submitSeek(std::FILE* file, uint64_t offset, std::atomic<int>* error);
+    void   submitClose(std::FILE* file, std::atomic<bool>* done, std::atomic<int>* error);
+
+    // Estadísticas: esperas por contrapresión y bytes escritos en disco
+    long long stallCount() const { return stalls_.load(std::memory_order_relaxed); }
+    long long bytesWritten() const { return bytesWritten_.load(std::memory_order_relaxed); }
+
+private:
+    enum class Op : uint8_t { WRITE, SEEK, CLOSE };
+
+    struct Job {
+        Op op;
+        std::FILE* file;
+        Block* block;
+        uint64_t offset;
+        std::atomic<bool>* done;
+        std::atomic<int>* error;
+    };
+
+    void submit(const Job& job);
+    void waitForRoom();
+    void writerLoop();
+
+    SpscRing<Job, 64>           jobs_;         // réplica -> escritor
+    SpscRing<Block*, MAX_BLOCKS> freeBlocks_;  // escritor -> réplica
+    std::vector<std::unique_ptr<Block>> pool_; // dueño de los bloques (sólo crece en el productor)
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> writerSleeping_{false};
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCondition_;
+
+    std::atomic<long long> stalls_{0};
+    std::atomic<long long> bytesWritten_{0};
+
+    std::thread thread_;
+};
+
+// Escritor del hilo actual (uno por hilo de réplica), creado en el primer uso
+AsyncWriter& defaultAsyncWriter();
+
+class AsyncStreamBuf : public std::streambuf {
+public:
+    AsyncStreamBuf() = default;
+    ~AsyncStreamBuf() override { close(); }
+
+    bool open(const std::string& path, AsyncWriter& writer);
+    bool isOpen() const { return file_ != nullptr; }
+
+    // Entrega lo pendiente, cierra el archivo en el escritor y espera a que termine.
+    // false si alguna escritura, posicionamiento o el cierre fallaron (ver error())
+    bool close();
+
+    const std::string& path() const { return path_; }
+    int error() const { return error_.load(std::memory_order_acquire); }
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    void handOff();
+
+    AsyncWriter* writer_ = nullptr;
+    std::FILE* file_ = nullptr;
+    AsyncWriter::Block* block_ = nullptr;
+    uint64_t blockStart_ = 0;   // posición en el archivo del comienzo de block_
+    std::string path_;
+    std::atomic<int> error_{0};
+};
+
+#endif // ASYNCWRITER_H
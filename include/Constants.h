@@ -7,6 +7,7 @@
 #include <vector>
 #include <cmath>
 #include <fstream>
+#include <string>
 #include <random>
 #include <set>
 #include <cstdint>
@@ -17,15 +18,19 @@
 // =================================================================================================
 // 1. CONSTANTES GLOBALES DE LA SIMULACIÓN
 // =================================================================================================
+// La configuración de las secciones 1 y 2 es thread_local: un barrido (--sweep) corre conjuntos
+// de parámetros distintos en hilos simultáneos. Un hilo nuevo arranca con los valores por
+// defecto; quien lo lanza le pasa la suya con captureConfig() / applyConfig().
 
 // Parámetros ajustables (configurables por línea de comandos)
-extern float BASE_RADIUS;
-extern float SIZE_RATIO;
-extern float CHI;
-extern int TOTAL_PARTICLES;
-extern float OUTLET_WIDTH;
-extern float SILO_WIDTH;
-extern float silo_height;
+extern thread_local float BASE_RADIUS;
+extern thread_local float SIZE_RATIO;
+extern thread_local float CHI;
+extern thread_local int TOTAL_PARTICLES;
+extern thread_local float OUTLET_WIDTH;
+extern thread_local float SILO_WIDTH;
+extern thread_local float silo_height;
+extern thread_local int NUM_THREADS;
 
 // Constantes físicas y temporales (const)
 const float TIME_STEP = 0.0005f; //0.005
@@ -36,7 +41,8 @@ const float MIN_AVALANCHE_DURATION = 0.5f;
 const float RAYCAST_COOLDOWN = 0.5f;
 const float SHOCK_INTERVAL = 0.1f;
 const int MAX_BLOCKAGE_RETRIES = 100;
-extern int MAX_AVALANCHES; 
+const float JAM_ARCH_MAX_SPEED = 0.05f;   // velocidad máx. de las partículas de un arco quieto
+extern thread_local int MAX_AVALANCHES; 
 
 // Constantes físicas internas
 const float Density = 1.0f;
@@ -47,75 +53,192 @@ const float GROUND_LEVEL_Y = 0.0f;
 const float EXIT_BELOW_Y = -1.5f;
 
 // Parámetros de reinyección configurables
-extern float REINJECT_HEIGHT_RATIO;
-extern float REINJECT_HEIGHT_VARIATION;
-extern float REINJECT_WIDTH_RATIO;
+extern thread_local float REINJECT_HEIGHT_RATIO;
+extern thread_local float REINJECT_HEIGHT_VARIATION;
+extern thread_local float REINJECT_WIDTH_RATIO;
+extern thread_local float REINJECT_VELOCITY;      // velocidad inicial hacia abajo de las reinyectadas (--reinject-velocity)
+
+// Paso de tiempo adaptativo en la fase de flujo (--adaptive-dt 1, ver AdaptiveStepping.h)
+extern thread_local bool ADAPTIVE_STEPPING;
+extern thread_local float ADAPTIVE_DT_MIN;
+extern thread_local float ADAPTIVE_DT_MAX;
+extern thread_local int ADAPTIVE_SUBSTEPS_MIN;
+extern thread_local int ADAPTIVE_SUBSTEPS_MAX;
+extern thread_local float ADAPTIVE_CFL;
+extern thread_local float ADAPTIVE_MAX_OVERLAP;
+extern thread_local float ADAPTIVE_DT_GROWTH;
+extern thread_local int ADAPTIVE_OVERLAP_CHECK_EVERY;
+extern thread_local float ADAPTIVE_MAX_SUBSTEP;   // tope extra del subpaso (--max-substep); 0 = ninguno
+
+// Detección de salidas con sensores Box2D en lugar del barrido de posiciones (--exit-sensors 1)
+extern thread_local bool USE_EXIT_SENSORS;
+
+// Salida a disco en un hilo escritor aparte (--async-output 0 para escribir en el hilo de la réplica)
+extern thread_local bool ASYNC_OUTPUT;
+
+// Códec de simulation_data.bin: 0 = float32 crudo, 1 = delta cuantizado (--frame-codec)
+extern thread_local int FRAME_CODEC;
+extern thread_local float FRAME_TOLERANCE;        // cuantización relativa a BASE_RADIUS (--frame-tolerance)
+extern thread_local int FRAME_KEYFRAME_EVERY;     // frames entre keyframes (--keyframe-every)
+
+// Caché de empaquetamientos sedimentados (ver PackingCache.h); directorio vacío = desactivada
+extern thread_local std::string PACKING_CACHE_DIR;
+extern thread_local long long PACKING_SEED;       // -1 = índice de la réplica (--packing-seed)
+
+// Generador del empaquetamiento inicial (--packing-generator)
+enum PackingGenerator { PACKING_GENERATOR_BATCHES = 0, PACKING_GENERATOR_DEPOSITION = 1 };
+extern thread_local int PACKING_GENERATOR;
+
+// Detección del arco que se desarma en un atasco (--arch-detection)
+enum ArchDetection { ARCH_DETECTION_RAYCAST = 0, ARCH_DETECTION_CONTACTS = 1 };
+extern thread_local int ARCH_DETECTION;
+
+// Atasco anticipado: sin salidas durante este tiempo y con un arco quieto sobre el orificio
+// (--jam-confirm-time); 0 = sólo el umbral BLOCKAGE_THRESHOLD
+extern thread_local float JAM_CONFIRM_TIME;
+
+// Saltea los atascos con todo dormido hasta el próximo desarme (--jam-fast-forward)
+extern thread_local bool JAM_FAST_FORWARD;
+
+// Región de interés: altura (en aberturas) sobre la que se congela el volumen (--roi-height); 0 = todo
+extern thread_local float ROI_HEIGHT;
+
+// Retención multi-paso (--multirate k, --multirate-zone H): el volumen lento por encima de H
+// aberturas es cinemático k-1 de cada k pasos (aproximación, ver MultiRate.h); k = 1 la desactiva
+extern thread_local int MULTIRATE_RATIO;
+extern thread_local float MULTIRATE_ZONE;
+
+// Todas las réplicas descargan la misma foto sedimentada; sólo cambia su semilla (--fork-discharges 1)
+extern thread_local bool FORK_DISCHARGES;
 
 // =================================================================================================
-// 2. VARIABLES DE ESTADO Y DATOS GLOBALES (extern)
+// 2. VARIABLES DE ESTADO Y DATOS GLOBALES (extern thread_local)
 // =================================================================================================
 
 // Parámetros de partículas
-extern int NUM_LARGE_CIRCLES;
-extern int NUM_SMALL_CIRCLES;
-extern int NUM_POLYGON_PARTICLES;
-extern int NUM_SIDES;
-extern float POLYGON_PERIMETER;
+extern thread_local int NUM_LARGE_CIRCLES;
+extern thread_local int NUM_SMALL_CIRCLES;
+extern thread_local int NUM_POLYGON_PARTICLES;
+extern thread_local int NUM_SIDES;
+extern thread_local float POLYGON_PERIMETER;
 
 // Variables derivadas
-extern float OUTLET_X_HALF_WIDTH;
+extern thread_local float OUTLET_X_HALF_WIDTH;
+
+// Control de réplicas y guardado
+extern thread_local bool SAVE_SIMULATION_DATA;
+extern thread_local int TOTAL_SIMULATIONS;
+extern thread_local int PARALLEL_REPLICAS;
+extern thread_local long long RANDOM_SEED;        // semilla global de los flujos aleatorios (--seed); -1 = reloj
+
+// Barrido de parámetros (--sweep <dir|manifiesto>); vacío = una sola configuración
+extern thread_local std::string SWEEP_SOURCE;
+// Cola compartida entre procesos/nodos (--queue-dir, ver WorkQueue.h) y vencimiento de sus reservas
+extern thread_local std::string QUEUE_DIR;
+extern thread_local float LEASE_TTL;                // s sin renovar para dar por caído al dueño (--lease-ttl)
+
+// Foto de la configuración de un hilo (secciones 1 y 2 más las frecuencias de main.cpp).
+// Sólo los hilos que corren réplicas reciben la configuración con applyConfig(). Los hilos
+// auxiliares (escritura de AsyncWriter, workers de TaskScheduler, renovación de reservas de la
+// cola) ven la copia thread_local de otro hilo, con los valores por defecto, tanto de esta
+// configuración como del estado de la réplica (secciones 3 y siguientes): no deben leer estas
+// variables, y lo que necesiten se les pasa al crearlos.
+#define SIMULATION_CONFIG_FIELDS(X) \
+    X(float, BASE_RADIUS) X(float, SIZE_RATIO) X(float, CHI) X(int, TOTAL_PARTICLES) \
+    X(float, OUTLET_WIDTH) X(float, SILO_WIDTH) X(float, silo_height) X(int, NUM_THREADS) \
+    X(int, MAX_AVALANCHES) \
+    X(float, REINJECT_HEIGHT_RATIO) X(float, REINJECT_HEIGHT_VARIATION) \
+    X(float, REINJECT_WIDTH_RATIO) X(float, REINJECT_VELOCITY) \
+    X(bool, ADAPTIVE_STEPPING) X(float, ADAPTIVE_DT_MIN) X(float, ADAPTIVE_DT_MAX) \
+    X(int, ADAPTIVE_SUBSTEPS_MIN) X(int, ADAPTIVE_SUBSTEPS_MAX) X(float, ADAPTIVE_CFL) \
+    X(float, ADAPTIVE_MAX_OVERLAP) X(float, ADAPTIVE_DT_GROWTH) X(int, ADAPTIVE_OVERLAP_CHECK_EVERY) \
+    X(float, ADAPTIVE_MAX_SUBSTEP) \
+    X(bool, USE_EXIT_SENSORS) X(bool, ASYNC_OUTPUT) \
+    X(int, FRAME_CODEC) X(float, FRAME_TOLERANCE) X(int, FRAME_KEYFRAME_EVERY) \
+    X(std::string, PACKING_CACHE_DIR) X(long long, PACKING_SEED) X(int, PACKING_GENERATOR) \
+    X(int, ARCH_DETECTION) X(float, JAM_CONFIRM_TIME) X(bool, JAM_FAST_FORWARD) \
+    X(float, ROI_HEIGHT) X(int, MULTIRATE_RATIO) X(float, MULTIRATE_ZONE) X(bool, FORK_DISCHARGES) \
+    X(int, NUM_LARGE_CIRCLES) X(int, NUM_SMALL_CIRCLES) X(int, NUM_POLYGON_PARTICLES) \
+    X(int, NUM_SIDES) X(float, POLYGON_PERIMETER) X(float, OUTLET_X_HALF_WIDTH) \
+    X(bool, SAVE_SIMULATION_DATA) X(int, TOTAL_SIMULATIONS) X(int, PARALLEL_REPLICAS) \
+    X(long long, RANDOM_SEED) \
+    X(int, EXIT_CHECK_EVERY_STEPS) X(int, SAVE_FRAME_EVERY_STEPS)
+
+struct SimulationConfig {
+#define SIMULATION_CONFIG_MEMBER(type, name) type name;
+    SIMULATION_CONFIG_FIELDS(SIMULATION_CONFIG_MEMBER)
+#undef SIMULATION_CONFIG_MEMBER
+};
+
+// Copia la configuración del hilo actual / la instala en el hilo actual
+SimulationConfig captureConfig();
+void applyConfig(const SimulationConfig& config);
 
+// Marca que el hilo actual tiene su configuración (applyConfig lo hace solo; el hilo principal,
+// al terminar de leer los argumentos). requireConfig aborta, salvo con NDEBUG, si un hilo que no
+// la recibió entra a código que la lee (captureConfig, beginReplica, defaultTaskScheduler,
+// defaultAsyncWriter): evita que un hilo auxiliar corra en silencio con los valores por defecto.
+void markConfigApplied();
+void requireConfig(const char* where);
+
+
+// =================================================================================================
+// 3. ESTADO POR RÉPLICA (thread_local: cada hilo de réplica tiene su propia copia)
+// =================================================================================================
+// resetRunState() las devuelve a sus valores iniciales al comenzar cada réplica.
 
 // Variables de estado y registro
-extern float simulationTime;
-extern float lastPrintTime;
-extern float lastRaycastTime;
-extern float lastShockTime;
-extern int frameCounter;
-extern bool SAVE_SIMULATION_DATA;
-extern int CURRENT_SIMULATION;
-extern int TOTAL_SIMULATIONS;
+extern thread_local float simulationTime;
+extern thread_local float lastPrintTime;
+extern thread_local float lastRaycastTime;
+extern thread_local float lastShockTime;
+extern thread_local float lastArchCheckTime;
+extern thread_local int frameCounter;
+extern thread_local int CURRENT_SIMULATION;
 
 // Archivos de salida
-extern std::ofstream simulationDataFile;
-extern std::ofstream avalancheDataFile;
-extern std::ofstream flowDataFile;
+extern thread_local std::ofstream simulationDataFile;
+extern thread_local std::ofstream avalancheDataFile;
+extern thread_local std::ofstream flowDataFile;
+extern thread_local std::ofstream adaptiveStepFile;
+extern thread_local std::ofstream archDataFile;
 
 // Variables de flujo
-extern int avalancheCount;
-extern float totalFlowingTime;
-extern float totalBlockageTime;
-extern bool inAvalanche;
-extern bool inBlockage;
-extern float blockageStartTime;
-extern float avalancheStartTime;
-extern int particlesInCurrentAvalanche;
-extern int avalancheStartParticleCount;
-extern float lastExitDuringAvalanche;
-extern float lastParticleExitTime;
-extern float previousBlockageDuration;
-extern int blockageRetryCount;
+extern thread_local int avalancheCount;
+extern thread_local float totalFlowingTime;
+extern thread_local float totalBlockageTime;
+extern thread_local bool inAvalanche;
+extern thread_local bool inBlockage;
+extern thread_local float blockageStartTime;
+extern thread_local float jamBreakDelay;        // espera desde la detección hasta el primer desarme
+extern thread_local float avalancheStartTime;
+extern thread_local int particlesInCurrentAvalanche;
+extern thread_local int avalancheStartParticleCount;
+extern thread_local float lastExitDuringAvalanche;
+extern thread_local float lastParticleExitTime;
+extern thread_local float previousBlockageDuration;
+extern thread_local int blockageRetryCount;
 
 // Variables de registro de flujo
-extern float totalExitedMass;
-extern int totalExitedParticles;
-extern float totalExitedOriginalMass;
-extern int totalExitedOriginalParticles;
-extern float lastRecordedTime;
-extern float accumulatedMass;
-extern int accumulatedParticles;
-extern float accumulatedOriginalMass;
-extern int accumulatedOriginalParticles;
+extern thread_local float totalExitedMass;
+extern thread_local int totalExitedParticles;
+extern thread_local float totalExitedOriginalMass;
+extern thread_local int totalExitedOriginalParticles;
+extern thread_local float lastRecordedTime;
+extern thread_local float accumulatedMass;
+extern thread_local int accumulatedParticles;
+extern thread_local float accumulatedOriginalMass;
+extern thread_local int accumulatedOriginalParticles;
 
 // Variables para seguimiento de progreso real del flujo
-extern int lastTotalExitedCount;
-extern float lastProgressTime;
-extern bool waitingForFlowConfirmation;
+extern thread_local int lastTotalExitedCount;
+extern thread_local float lastProgressTime;
+extern thread_local bool waitingForFlowConfirmation;
 
-// RNG Engine y distribuciones
-extern std::mt19937 randomEngine;
-extern std::uniform_real_distribution<> angleDistribution;
-extern std::uniform_real_distribution<> impulseMagnitudeDistribution;
+// RNG Engine y distribuciones (árbol src/; src_v2 usa los flujos de RandomStreams.h)
+extern thread_local std::mt19937 randomEngine;
+extern thread_local std::uniform_real_distribution<> angleDistribution;
+extern thread_local std::uniform_real_distribution<> impulseMagnitudeDistribution;
 
 // Comparador para b2BodyId en std::set
 struct BodyIdComparator {
@@ -124,6 +247,9 @@ struct BodyIdComparator {
     }
 };
 
-extern std::set<b2BodyId, BodyIdComparator> particlesExitedInCurrentAvalanche;
+extern thread_local std::set<b2BodyId, BodyIdComparator> particlesExitedInCurrentAvalanche;
+
+// Reinicia el estado por réplica del hilo actual (contadores, archivos, RNG)
+void resetRunState(int simulationIndex, uint64_t seed);
 
 #endif // CONSTANTS_H
\ No newline at end of file
@@ -16,19 +16,46 @@ struct RaycastUserData {
 // Declaraciones de funciones
 float RaycastCallback(b2ShapeId shapeId, b2Vec2 point, b2Vec2 normal, float fraction, void* context);
 
+// Directorio de resultados de la réplica CURRENT_SIMULATION con la configuración del hilo
+std::string replicaOutputDirectory();
+// Si no está vacío, las réplicas siguientes del hilo escriben en dir (terminado en '/') en lugar
+// de replicaOutputDirectory(); quien lo fija publica el resultado (ver WorkQueue.h)
+void setReplicaStagingDirectory(const std::string& dir);
 void initializeDataFiles();
 void finalizeDataFiles(bool simulationInterrupted);
+// Frame de partículas (desde stateSnapshot) en simulation_data.bin
+void recordFrame(uint64_t step, float currentTime);
 
 void applyRandomImpulses();
 void manageParticles(b2WorldId worldId, float currentTime, float siloHeight,
                      int& exitedTotalCount, float& exitedTotalMass,
                      int& exitedOriginalCount, float& exitedOriginalMass);
+// Variante por sensores (--exit-sensors 1): consume b2World_GetSensorEvents cada paso
+void manageParticlesFromSensors(b2WorldId worldId, float currentTime, float siloHeight,
+                                int& exitedTotalCount, float& exitedTotalMass,
+                                int& exitedOriginalCount, float& exitedOriginalMass);
 void recordFlowData(float currentTime, int exitedTotalCount, float exitedTotalMass,
                     int exitedOriginalCount, float exitedOriginalMass);
 void detectAndReinjectArchViaRaycast(b2WorldId worldId, float siloHeight);
+// Desarma un atasco: el arco del grafo de contactos (ArchDetection.h), registrado en
+// arch_data.csv; si no se encuentra (o con --arch-detection raycast), el barrido por rayos
+void breakArch(b2WorldId worldId, float siloHeight);
 void finalizeAvalanche();
 void startAvalanche(); 
 void startBlockage(); 
+// Variante con el instante del fin de la avalancha
+void finalizeAvalancheAt(float endTime);
 void checkFlowStatus(b2WorldId worldId, float timeSinceLastExit);
 
+// Instante del próximo intento de desarme del atasco en curso (primer intento o fin del cooldown)
+float nextJamBreakTime();
+
+// Con el atasco en curso y todos los cuerpos dormidos (lo verifica el llamador: worldQuiescent,
+// o RoiController::quiescent con la región de interés), b2World_Step no cambia nada hasta el
+// próximo desarme: adelanta simulationTime hasta nextJamBreakTime() y completa flow_data.csv
+// con flujo nulo. totalBlockageTime sale de blockageStartTime al reanudarse el flujo, y
+// lastRaycastTime/blockageRetryCount los actualiza el desarme en el tiempo adelantado.
+// Devuelve true si adelantó.
+bool fastForwardJam();
+
 #endif // DATAHANDLING_H
\ No newline at end of file
@@ -0,0 +1,177 @@
+// include/FrameFormat.h
+
+#ifndef FRAMEFORMAT_H
+#define FRAMEFORMAT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "TrajectoryCodec.h"
+
+// =================================================================================================
+// FORMATO BINARIO DE FRAMES (simulation_data.bin)
+// =================================================================================================
+//
+// Reemplaza a simulation_data.csv. Todo en orden de bytes del host (little-endian en x86/ARM):
+//
+//   FrameFileHeader                       (64 bytes)
+//   uint8  type [N]                       atributos estáticos, escritos una sola vez
+//   uint8  sides[N]
+//   float  size [N]
+//   repetido por frame:
+//     FrameRecordHeader                   (24 bytes)
+//     payload de payloadBytes bytes       codec RAW:   float x[N], float y[N], float angle[N]
+//                                         codec DELTA: residuos cuantizados (TrajectoryCodec.h)
+//   FrameIndexEntry[frameCount]           índice al final; indexOffset apunta a él
+//
+// frameCount e indexOffset se completan al cerrar. Si la corrida se cortó antes (indexOffset = 0)
+// el lector recorre los frames secuencialmente usando payloadBytes.
+//
+// Con el códec DELTA sólo los keyframes (FRAME_FLAG_KEYFRAME, uno cada keyframeInterval frames)
+// se decodifican solos; para llegar a un frame cualquiera se arranca del keyframe anterior.
+
+namespace frames {
+
+constexpr char     MAGIC[8] = {'S', 'I', 'L', 'O', 'F', 'R', 'M', '1'};
+constexpr uint32_t VERSION  = 1;
+
+enum Codec : uint32_t {
+    CODEC_RAW_F32 = 0,      // x, y, angle en float32, columna por columna
+    CODEC_DELTA_Q = 1,      // cuantizado, delta respecto del frame anterior, Rice adaptativo
+};
+
+constexpr uint32_t FRAME_FLAG_KEYFRAME = 1u;
+
+struct FrameFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t particleCount;
+    uint32_t codec;
+    uint32_t reserved0;
+    uint64_t frameCount;    // completado al cerrar
+    uint64_t indexOffset;   // completado al cerrar (0 = sin índice)
+    float    baseRadius;
+    float    posQuantum;         // códec DELTA: paso de cuantización de x, y [m]
+    float    angleQuantum;       // códec DELTA: paso de cuantización del ángulo [rad]
+    uint32_t keyframeInterval;   // códec DELTA: frames entre keyframes
+    uint8_t  reserved1[8];
+};
+static_assert(sizeof(FrameFileHeader) == 64, "FrameFileHeader debe medir 64 bytes");
+
+struct FrameRecordHeader {
+    uint64_t step;          // frameCounter del simulador
+    double   time;          // simulationTime
+    uint32_t payloadBytes;
+    uint32_t flags;         // FRAME_FLAG_KEYFRAME
+};
+static_assert(sizeof(FrameRecordHeader) == 24, "FrameRecordHeader debe medir 24 bytes");
+
+struct FrameIndexEntry {
+    uint64_t step;
+    double   time;
+    uint64_t offset;        // posición del FrameRecordHeader en el archivo
+};
+static_assert(sizeof(FrameIndexEntry) == 24, "FrameIndexEntry debe medir 24 bytes");
+
+// Atributos estáticos por partícula (mismos valores que las columnas _type/_size/_sides del CSV)
+struct StaticColumns {
+    std::vector<uint8_t> type;
+    std::vector<uint8_t> sides;
+    std::vector<float>   size;
+};
+
+// Códec de escritura. tolerance es relativa a baseRadius: error máx. de posición tolerance*R/2
+// (más el redondeo de float32), de ángulo tolerance/2 rad (el mismo arco en el borde de radio R)
+struct CodecConfig {
+    uint32_t codec = CODEC_RAW_F32;
+    float    tolerance = 1e-4f;
+    uint32_t keyframeInterval = 100;
+};
+
+// Un frame decodificado
+struct Frame {
+    uint64_t step = 0;
+    double   time = 0.0;
+    std::vector<float> x, y, angle;
+};
+
+// =========================================================
+// ESCRITURA
+// =========================================================
+
+class FrameWriter {
+public:
+    FrameWriter() = default;
+    ~FrameWriter() { close(); }
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    bool open(const std::string& path, const StaticColumns& columns, float baseRadius,
+              const CodecConfig& codec = CodecConfig());
+    // Variante sobre un streambuf ajeno (p.ej. AsyncStreamBuf); debe admitir pubseekpos
+    bool open(std::streambuf* out, const StaticColumns& columns, float baseRadius,
+              const CodecConfig& codec = CodecConfig());
+    bool isOpen() const { return out_ != nullptr; }
+
+    // x, y, angle deben tener particleCount elementos
+    void writeFrame(uint64_t step, double time,
+                    const float* x, const float* y, const float* angle);
+
+    // Escribe el índice y completa el encabezado (un streambuf ajeno lo cierra su dueño)
+    void close();
+
+private:
+    void put(const void* data, size_t bytes);
+
+    std::filebuf ownFile_;
+    std::streambuf* out_ = nullptr;
+    uint64_t position_ = 0;
+    FrameFileHeader header_{};
+    std::vector<FrameIndexEntry> index_;
+    trajectory::Encoder encoder_;
+    std::vector<uint8_t> payload_;
+};
+
+// =========================================================
+// LECTURA SECUENCIAL
+// =========================================================
+
+class FrameReader {
+public:
+    FrameReader() = default;
+    ~FrameReader() { close(); }
+
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const FrameFileHeader& header() const { return header_; }
+    const StaticColumns&   columns() const { return columns_; }
+    uint32_t particleCount() const { return header_.particleCount; }
+
+    // Siguiente frame en orden de archivo; false al llegar al final (o al índice)
+    bool next(Frame& frame);
+
+private:
+    std::FILE* file_ = nullptr;
+    FrameFileHeader header_{};
+    StaticColumns columns_;
+    uint64_t dataEnd_ = 0;
+    trajectory::Decoder decoder_;
+    std::vector<uint8_t> payload_;
+};
+
+// Encabezado del CSV histórico (mismas columnas que escribía initializeDataFiles)
+void writeCsvHeader(std::FILE* out, uint32_t particleCount);
+// Una fila del CSV histórico (Time, luego x,y,type,size,sides,angle por partícula)
+void writeCsvRow(std::FILE* out, const StaticColumns& columns, const Frame& frame);
+
+} // namespace frames
+
+#endif // FRAMEFORMAT_H
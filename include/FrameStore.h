@@ -0,0 +1,73 @@
+// include/FrameStore.h
+
+#ifndef FRAMESTORE_H
+#define FRAMESTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FrameFormat.h"
+
+// =================================================================================================
+// LECTOR DE FRAMES CON MEMORIA MAPEADA (simulation_data.bin)
+// =================================================================================================
+//
+// Mapea el archivo completo (mmap, sólo lectura) y arma el índice de frames: el del final del
+// archivo si existe, o uno construido recorriendo los registros si la corrida se cortó. El SO
+// trae a memoria sólo las páginas de los frames que se leen, así que una corrida larga se puede
+// recorrer en una estación de trabajo sin cargarla entera.
+//
+// Acceso aleatorio: con el códec RAW leer el frame k es O(1). Con el códec DELTA se decodifica
+// desde el keyframe anterior (a lo sumo keyframeInterval frames); la lectura secuencial (k, k+1,
+// ...) continúa desde el estado del decodificador y cuesta un frame por llamada.
+
+namespace frames {
+
+class FrameStore {
+public:
+    FrameStore() = default;
+    ~FrameStore() { close(); }
+
+    FrameStore(const FrameStore&) = delete;
+    FrameStore& operator=(const FrameStore&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const FrameFileHeader& header() const { return header_; }
+    const StaticColumns&   columns() const { return columns_; }
+    uint32_t particleCount() const { return header_.particleCount; }
+
+    size_t   frameCount() const { return index_.size(); }
+    double   time(size_t k) const { return index_[k].time; }
+    uint64_t step(size_t k) const { return index_[k].step; }
+
+    // Frame k decodificado en out; false si k está fuera de rango o el registro está dañado
+    bool read(size_t k, Frame& out);
+
+    // Primer frame con time >= minTime (los tiempos son crecientes)
+    size_t lowerBound(double minTime) const;
+
+    // Frames con minTime <= time <= maxTime, tomando uno cada frameStep
+    std::vector<size_t> select(double minTime, double maxTime, size_t frameStep) const;
+
+private:
+    bool recordAt(size_t k, FrameRecordHeader& record, const uint8_t*& payload) const;
+    bool decodeRecord(size_t k, Frame& out);
+
+    int fd_ = -1;
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+
+    FrameFileHeader header_{};
+    StaticColumns columns_;
+    std::vector<FrameIndexEntry> index_;
+
+    trajectory::Decoder decoder_;
+    long long lastDecoded_ = -1;    // último frame DELTA decodificado (estado del decodificador)
+};
+
+} // namespace frames
+
+#endif // FRAMESTORE_H
@@ -6,10 +6,11 @@
 #include "box2d/box2d.h"
 #include <vector>
 #include <string>
+#include <cstdint>
 #include "Constants.h"
 
-// Variables de Box2D Globales
-extern b2WorldId worldId;
+// Mundo Box2D de la réplica en curso (uno por hilo de réplica)
+extern thread_local b2WorldId worldId;
 
 // Estructuras de datos específicas de partículas
 enum ParticleShapeType { CIRCLE, POLYGON };
@@ -23,15 +24,32 @@ struct ParticleInfo {
     int numSides;
 };
 
-// Contenedores globales
-extern std::vector<ParticleInfo> particles;
-extern std::vector<b2BodyId> particleBodyIds;
+// Contenedores de la réplica en curso (uno por hilo de réplica)
+extern thread_local std::vector<ParticleInfo> particles;
+extern thread_local std::vector<b2BodyId> particleBodyIds;
+
+// Sensor bajo el orificio (modo --exit-sensors); el resto de los sensores son "catch-all"
+extern thread_local b2ShapeId outletSensorShapeId;
+
+// El userData de cada cuerpo de partícula guarda su índice en particles (+1, 0 = no partícula)
+inline void setParticleIndex(b2BodyId bodyId, int index) {
+    b2Body_SetUserData(bodyId, reinterpret_cast<void*>(static_cast<intptr_t>(index + 1)));
+}
+inline int getParticleIndex(b2BodyId bodyId) {
+    return static_cast<int>(reinterpret_cast<intptr_t>(b2Body_GetUserData(bodyId))) - 1;
+}
 
 // Declaraciones de funciones
 bool parseAndValidateArgs(int argc, char** argv);
 bool calculateDerivedParameters();
 b2WorldId createWorldAndWalls(b2BodyId& outletBlockIdRef);
+void destroyWorld(b2WorldId worldId);
+void createExitSensors(b2WorldId worldId);
 void createParticles(b2WorldId worldId);
-void runSedimentation(b2WorldId worldId);
+// Crea una partícula (cuerpo + forma) y la agrega a particles/particleBodyIds.
+// Polígonos: size = circunradio, numSides <= BOX2D_MAX_POLYGON_VERTICES.
+b2BodyId createParticleBody(b2WorldId worldId, ParticleShapeType type, float size, int numSides,
+                            bool isOriginal, b2Vec2 position, b2Rot rotation);
+bool runSedimentation(b2WorldId worldId);
 
 #endif // INITIALIZATION_H
\ No newline at end of file
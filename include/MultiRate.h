@@ -0,0 +1,87 @@
+// include/MultiRate.h
+
+#ifndef MULTIRATE_H
+#define MULTIRATE_H
+
+#include <vector>
+#include "box2d/box2d.h"
+#include "Constants.h"
+#include "Initialization.h"
+
+// =================================================================================================
+// RETENCIÓN CINEMÁTICA DEL VOLUMEN LEJANO (--multirate k)
+// =================================================================================================
+//
+// No es un paso grueso: Box2D integra el mundo con un único dt y los subpasos por segundo no
+// cambian. Lo que se ahorra es el solver de las partículas retenidas, que durante k-1 de cada k
+// pasos son cinemáticas. Cada k pasos finos:
+//   - paso de borde: todas las partículas son dinámicas. Antes de integrarlo, las retenidas
+//     recuperan su velocidad más la gravedad acumulada durante la retención (g * tiempo
+//     retenido);
+//   - después del paso de borde, las partículas despiertas por encima de la zona del orificio
+//     (MULTIRATE_ZONE * OUTLET_WIDTH) y lentas se retienen: pasan a cinemáticas con su
+//     velocidad y derivan en línea recta durante los k-1 pasos finos siguientes. Las dormidas
+//     y las que están por dormirse (por debajo del umbral de sueño de Box2D) no se tocan, para
+//     que el volumen en reposo se siga durmiendo.
+//
+// Es una aproximación, no un esquema acoplado: una cinemática tiene masa infinita y no pesa,
+// así que durante los k-1 pasos retenidos la zona del orificio ve al volumen como una pared
+// rígida que se mueve con su velocidad y no recibe la sobrecarga; el solver de contactos no
+// recupera en el paso de borde el impulso de los pasos salteados. Para acotar el error sólo se
+// retienen partículas cuyo desplazamiento en el intervalo (|v| (k-1) dt, también el del borde
+// por rotación) no supera MULTIRATE_MAX_DRIFT radios mínimos; las rápidas (p. ej. reinyectadas
+// en caída) siguen dinámicas.
+//
+// Por eso viene desactivada (k = 1) y, como --roi-height, sólo debe usarse después de
+// comprobar con la configuración de producción que el caudal y la distribución de avalanchas
+// no cambian dentro del error estadístico:
+//   python3 script/regression.py --update-golden
+//   python3 script/regression.py --skip-perf --set MULTIRATE=4
+// El costo son dos b2Body_SetType por partícula retenida cada k pasos (cada uno saca y vuelve
+// a meter el cuerpo en las islas y el árbol de cuerpos); sólo conviene si el volumen despierto
+// es grande y el solver domina el paso. Medirlo con make bench BENCH_ARGS="--filter multirate".
+
+class MultiRateController {
+public:
+    /**
+     * Prepara el controlador para las partículas de la réplica (radio mínimo, gravedad).
+     */
+    void reset(b2WorldId worldId, const std::vector<ParticleInfo>& particles);
+
+    /**
+     * Antes de b2World_Step: en el paso de borde devuelve las retenidas a dinámicas.
+     */
+    void beforeStep(const std::vector<ParticleInfo>& particles);
+
+    /**
+     * Después de b2World_Step(dt): acumula el tiempo retenido y, tras el paso de borde,
+     * retiene el volumen lento.
+     */
+    void afterStep(float dt, const std::vector<ParticleInfo>& particles);
+
+    int heldCount() const { return (int)heldList_.size(); }
+
+    // Fracción de pasos partícula integrados como dinámicos (1 = sin ahorro)
+    double dynamicFraction() const {
+        return totalBodySteps_ > 0 ? 1.0 - (double)heldBodySteps_ / totalBodySteps_ : 1.0;
+    }
+
+private:
+    void hold(float dt, const std::vector<ParticleInfo>& particles);
+    void release(const std::vector<ParticleInfo>& particles);
+
+    int   ratio_ = 1;
+    int   phase_ = 0;
+    float zoneTop_ = 0.0f;
+    float minRadius_ = 0.0f;
+    float heldTime_ = 0.0f;
+    float restSpeed_ = 0.0f;                          // umbral de sueño de Box2D
+    b2Vec2 gravity_ = {0.0f, -9.8f};
+
+    std::vector<int>     heldList_;
+    std::vector<float>   heldVx_, heldVy_, heldW_;    // velocidad al retener (por partícula)
+
+    long long heldBodySteps_ = 0, totalBodySteps_ = 0;
+};
+
+#endif // MULTIRATE_H
@@ -0,0 +1,88 @@
+// include/PackingCache.h
+
+#ifndef PACKINGCACHE_H
+#define PACKINGCACHE_H
+
+#include "box2d/box2d.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =================================================================================================
+// CACHÉ DE EMPAQUETAMIENTOS SEDIMENTADOS (--packing-cache <dir>)
+// =================================================================================================
+//
+// createParticles + runSedimentation suelen costar más tiempo de reloj que la descarga misma.
+// Con la caché activa, el empaquetamiento ya estabilizado (con la salida tapada) se guarda en
+// <dir>/packing_<clave>.bin y las réplicas siguientes con la misma clave lo recrean directamente
+// en el mundo nuevo y abren el silo sin sedimentar.
+//
+// La clave es un hash de la geometría del silo, la mezcla de partículas y la semilla del
+// empaquetamiento (--packing-seed, o el índice de la réplica si no se indica). Con la caché
+// activa la generación usa esa semilla, así que el contenido de cada archivo queda determinado
+// por su clave; los flujos aleatorios vuelven a los de la réplica antes de la descarga.
+//
+// Formato (orden de bytes del host):
+//
+//   PackingFileHeader                     (24 bytes)
+//   PackedParticle[particleCount]         (36 bytes c/u) tipo, forma, pose y velocidad
+//
+// Se escribe en un temporal y se renombra: réplicas en paralelo con la misma clave nunca ven
+// un archivo a medio escribir.
+
+namespace packing {
+
+constexpr char     MAGIC[8] = {'S', 'I', 'L', 'O', 'P', 'A', 'K', '1'};
+constexpr uint32_t VERSION  = 1;
+
+struct PackingFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t particleCount;
+    uint64_t key;
+};
+static_assert(sizeof(PackingFileHeader) == 24, "PackingFileHeader debe medir 24 bytes");
+
+struct PackedParticle {
+    uint8_t type;           // ParticleShapeType
+    uint8_t isOriginal;
+    uint8_t sides;          // 0 para círculos
+    uint8_t reserved;
+    float   size;           // radio o circunradio
+    float   x, y;
+    float   cosA, sinA;
+    float   vx, vy, w;
+};
+static_assert(sizeof(PackedParticle) == 36, "PackedParticle debe medir 36 bytes");
+
+// Empaquetamiento en memoria: el contenido de un archivo de la caché, o la foto compartida por
+// las ramas de descarga de --fork-discharges
+struct Packing {
+    uint64_t key = 0;
+    std::vector<PackedParticle> particles;
+
+    bool empty() const { return particles.empty(); }
+};
+
+// Foto de las partículas de la réplica en curso (poses y velocidades de stateSnapshot)
+void capturePacking(uint64_t key, Packing& out);
+
+// Recrea las partículas en worldId (particles, particleBodyIds y stateSnapshot)
+void restorePacking(b2WorldId worldId, const Packing& packing);
+
+// Clave de la caché para los parámetros actuales y la semilla del empaquetamiento
+uint64_t packingKey(uint64_t seed);
+
+// <PACKING_CACHE_DIR>/packing_<clave en hex>.bin
+std::string packingPath(uint64_t key);
+
+// Recrea en worldId las partículas guardadas (particles, particleBodyIds y stateSnapshot).
+// false si no hay archivo o no corresponde a la clave; en ese caso no se crea nada.
+bool loadPacking(b2WorldId worldId, uint64_t key);
+
+// Guarda las partículas de la réplica en curso (lee poses y velocidades de stateSnapshot)
+bool savePacking(uint64_t key);
+
+} // namespace packing
+
+#endif // PACKINGCACHE_H
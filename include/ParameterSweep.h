@@ -0,0 +1,60 @@
+// include/ParameterSweep.h
+
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "Constants.h"
+#include "SimulationContext.h"
+
+// =================================================================================================
+// BARRIDO DE PARÁMETROS EN PROCESO (--sweep <dir|manifiesto>)
+// =================================================================================================
+//
+// Reemplaza el lanzar un proceso por archivo de parámetros con ejecutar_simulacion.sh:
+//   - los archivos KEY=VALUE (mismo formato y mismas claves que el script) se leen acá y se
+//     aplican sobre la configuración de la línea de comandos, uno por conjunto;
+//   - <dir>: todos los .txt del directorio, en orden natural (parametros_2 antes que _10);
+//     <manifiesto>: un archivo por línea (relativo al manifiesto; # comenta);
+//   - cada (conjunto, réplica) es una tarea. Las tareas se reparten en colas por hilo y un
+//     hilo sin trabajo roba de la cola más cargada, así un conjunto con atascos largos no
+//     deja hilos ociosos al final. Cada hilo instala la configuración de su tarea
+//     (applyConfig) antes de correrla.
+//
+// PARALLEL_REPLICAS de los archivos se ignora (el barrido decide cuántos hilos) y
+// FORK_DISCHARGES no se admite (la foto común es una sola por proceso).
+
+struct SweepSet {
+    std::string source;          // archivo de parámetros
+    SimulationConfig config;     // configuración resuelta (con parámetros derivados)
+    int firstIndex = 1;          // CURRENT_SIM
+    int count = 1;               // TOTAL_SIMS
+};
+
+/**
+ * Lee un archivo KEY=VALUE y lo traduce a flags de parseAndValidateArgs. Las claves
+ * desconocidas se avisan y se ignoran. Devuelve false si no se pudo abrir.
+ */
+bool readParameterFile(const std::string& path, std::vector<std::string>& args);
+
+/**
+ * Arma los conjuntos del barrido. Cada archivo se aplica sobre la configuración actual del
+ * hilo (la de la línea de comandos), que queda intacta al volver.
+ */
+bool loadParameterSweep(const std::string& source, std::vector<SweepSet>& sets);
+
+/**
+ * Hilos del barrido: --parallel-replicas si se pidió más de uno; si no, los núcleos de la
+ * máquina divididos por el mayor --threads de los conjuntos.
+ */
+int sweepWorkerCount(const std::vector<SweepSet>& sets);
+
+/**
+ * Corre todas las tareas (conjunto, réplica) en `workers` hilos con robo de trabajo.
+ */
+void runParameterSweep(const std::vector<SweepSet>& sets, int workers,
+                       const std::function<void(SimulationContext&)>& body);
+
+#endif // PARAMETERSWEEP_H
@@ -0,0 +1,83 @@
+// include/PlacementGrid.h
+
+#ifndef PLACEMENTGRID_H
+#define PLACEMENTGRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// =================================================================================================
+// GRILLA DE COLOCACIÓN SIN SUPERPOSICIÓN (createParticles)
+// =================================================================================================
+//
+// Índice espacial plano para probar si una partícula candidata se superpone con las ya
+// colocadas, sin reservar memoria por intento:
+//   - celdas de lado cellSize >= diámetro máximo: alcanza con revisar el vecindario 3x3;
+//   - las partículas existentes se cargan con stage() y build() las ordena por celda con un
+//     counting sort (cellStart/cellItems contiguos);
+//   - las que se agregan después (add) se encadenan por celda con listas head/next planas;
+//   - por partícula se guardan una vez los vértices rotados y las normales de sus aristas.
+//
+// Pruebas exactas: círculo-círculo por distancia, círculo-polígono por región de Voronoi de la
+// arista de máxima separación, polígono-polígono por SAT con las normales guardadas.
+// Los polígonos son regulares, con el circunradio como tamaño (igual que createParticleBody).
+// clear() vacía la grilla conservando la capacidad de los buffers.
+
+class PlacementGrid {
+public:
+    // Región cubierta (las posiciones fuera de ella se recortan a las celdas del borde)
+    void reset(float minX, float minY, float maxX, float maxY, float cellSize);
+    void clear();
+
+    // Carga diferida de partículas existentes; build() arma las celdas
+    void stage(float x, float y, float cosA, float sinA, float radius, int sides);
+    void build();
+
+    // Agrega una partícula después de build()
+    void add(float x, float y, float cosA, float sinA, float radius, int sides);
+
+    // ¿La candidata (sides = 0 para círculos) se superpone con alguna partícula de la grilla?
+    bool overlaps(float x, float y, float cosA, float sinA, float radius, int sides) const;
+
+    size_t size() const { return px_.size(); }
+
+private:
+    struct Shape {
+        float x, y, radius;
+        int sides;                  // 0 = círculo
+        const float* vx;            // vértices en coordenadas de mundo (sides)
+        const float* vy;
+        const float* nx;            // normal exterior de la arista i -> i+1
+        const float* ny;
+    };
+
+    void append(float x, float y, float cosA, float sinA, float radius, int sides);
+    int  cellIndex(float x, float y) const;
+    Shape shapeOf(int item) const;
+    void transform(float x, float y, float cosA, float sinA, float radius, int sides,
+                   float* vx, float* vy, float* nx, float* ny) const;
+    const float* unitPolygon(int sides) const;   // cos/sin de vértices y normales, circunradio 1
+
+    static bool overlapShapes(const Shape& a, const Shape& b);
+
+    float minX_ = 0, minY_ = 0, cellSize_ = 1, invCell_ = 1;
+    int   nx_ = 1, ny_ = 1;
+
+    // Partículas (SoA); vértices y normales de mundo en arreglos planos desde vertStart_[i]
+    std::vector<float>    px_, py_, pr_;
+    std::vector<int>      sides_, vertStart_;
+    std::vector<float>    vx_, vy_, nxv_, nyv_;
+
+    // Counting sort (partículas de stage/build)
+    std::vector<int>      cellStart_, cellItems_, itemCell_;
+    size_t                built_ = 0;
+
+    // Listas encadenadas (partículas de add)
+    std::vector<int>      head_, next_;
+
+    // Tablas de polígonos regulares por cantidad de lados (vértices y normales unitarios)
+    mutable std::vector<std::vector<float>> unitPolys_;
+};
+
+#endif // PLACEMENTGRID_H
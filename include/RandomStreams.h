@@ -0,0 +1,77 @@
+// include/RandomStreams.h
+
+#ifndef RANDOMSTREAMS_H
+#define RANDOMSTREAMS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// =================================================================================================
+// FLUJOS ALEATORIOS POR RÉPLICA Y SUBSISTEMA (Philox4x32-10)
+// =================================================================================================
+//
+// Generador basado en contador: el bloque n de un flujo es Philox(contador, clave), con
+// clave = semilla (--seed) y contador = (n, réplica, subsistema). No hay estado compartido
+// entre réplicas ni entre subsistemas, así que:
+//   - réplicas en hilos distintos nunca compiten por el estado del RNG;
+//   - la réplica i produce siempre la misma secuencia para la misma semilla, sin importar
+//     cuántas réplicas corren en paralelo ni en qué orden;
+//   - consumir más números en un subsistema (p. ej. más reinyecciones) no altera a los demás.
+//
+// Cada flujo genera BATCH_BLOCKS bloques por vez en un buffer (4 enteros de 32 bits por
+// bloque) y los entrega de a uno; uniforms() llena un arreglo completo de una vez.
+
+enum RngSubsystem : uint32_t {
+    RNG_PLACEMENT = 0,    // posiciones/ángulos iniciales y orden de creación (createParticles)
+    RNG_REINJECTION,      // reinyección y desarme de arcos
+    RNG_SHOCKS,           // impulsos aleatorios
+    RNG_SUBSYSTEMS
+};
+
+class RandomStream {
+public:
+    // Interfaz UniformRandomBitGenerator (std::shuffle, distribuciones de <random>)
+    using result_type = uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    RandomStream() { seed(0, 0, 0); }
+
+    // Reinicia el flujo (contador de bloques en 0)
+    void seed(uint64_t seed, uint32_t replica, uint32_t subsystem);
+
+    result_type operator()() {
+        if (pos_ == BUFFER_WORDS) refill();
+        return buffer_[pos_++];
+    }
+
+    // Uniforme en [0, 1) con 24 bits de mantisa
+    float uniform() { return (float)((*this)() >> 8) * (1.0f / 16777216.0f); }
+    float uniform(float a, float b) { return a + (b - a) * uniform(); }
+
+    // n uniformes en [a, b) de una sola vez
+    void uniforms(float* out, size_t n, float a = 0.0f, float b = 1.0f);
+
+private:
+    static constexpr size_t BATCH_BLOCKS = 16;
+    static constexpr size_t BUFFER_WORDS = 4 * BATCH_BLOCKS;
+
+    void refill();
+
+    uint32_t key_[2];
+    uint32_t stream_[2];      // palabras altas del contador: réplica y subsistema
+    uint64_t block_ = 0;      // palabras bajas del contador: índice de bloque
+    uint32_t buffer_[BUFFER_WORDS];
+    size_t pos_ = BUFFER_WORDS;
+};
+
+// Un bloque Philox4x32-10 (expuesto para verificar contra los valores de referencia)
+void philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+// Flujo del subsistema para la réplica en curso (uno por hilo de réplica)
+RandomStream& rng(RngSubsystem subsystem);
+
+// Reinicia todos los flujos del hilo para la réplica replica con la semilla global seed
+void seedReplicaStreams(uint64_t seed, uint32_t replica);
+
+#endif // RANDOMSTREAMS_H
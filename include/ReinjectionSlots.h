@@ -0,0 +1,52 @@
+// include/ReinjectionSlots.h
+
+#ifndef REINJECTIONSLOTS_H
+#define REINJECTIONSLOTS_H
+
+#include <vector>
+#include "box2d/box2d.h"
+#include "Initialization.h"
+#include "PlacementGrid.h"
+
+// =================================================================================================
+// LUGARES DE REINYECCIÓN SIN SUPERPOSICIÓN (partículas recicladas por el orificio)
+// =================================================================================================
+//
+// La banda de reinyección (REINJECT_*) se cubre una vez con una red triangular de lugares
+// separados 2.1 radios máximos: dos partículas en lugares distintos no se superponen, aun con el
+// jitter que se les agrega (un disco de radio 0.05 radios máximos). En cada tanda:
+//   - las partículas presentes en la banda (foto del último paso) se cargan en una
+//     PlacementGrid;
+//   - los lugares se recorren en un orden aleatorio (flujo RNG_REINJECTION) y cada partícula
+//     pendiente ocupa el primero libre según la prueba exacta de la grilla, y se agrega a la
+//     grilla para que las siguientes de la tanda se prueben contra ella;
+//   - todas se teletransportan juntas, con velocidad inicial (0, -REINJECT_VELOCITY).
+// Si la banda está llena (superficie libre dentro de ella), las que no consiguen lugar se
+// reinyectan como antes, en un punto al azar de la banda, y se cuentan en fallbacks().
+
+class ReinjectionSlots {
+public:
+    // Rearma la red con las partículas de la réplica en curso y pone en cero los contadores
+    void reset();
+
+    // Reinyecta las partículas indices (índices de particles) en una sola tanda
+    void place(const std::vector<int>& indices, float siloHeight);
+
+    long long fallbacks() const { return fallbacks_; }
+
+private:
+    void buildLattice(float siloHeight);
+
+    float siloHeight_ = -1.0f;
+    float radius_ = 0.0f;                // radio máximo (circunradio de polígonos)
+    float minX_ = 0, maxX_ = 0, minY_ = 0, maxY_ = 0;
+    std::vector<b2Vec2> slots_;
+    std::vector<int>    order_;
+    PlacementGrid       grid_;
+    long long           fallbacks_ = 0;
+};
+
+// Tanda de reinyección de la réplica en curso (una por hilo de réplica)
+extern thread_local ReinjectionSlots reinjectionSlots;
+
+#endif // REINJECTIONSLOTS_H
@@ -0,0 +1,56 @@
+// include/SimulationContext.h
+
+#ifndef SIMULATIONCONTEXT_H
+#define SIMULATIONCONTEXT_H
+
+#include <functional>
+#include "box2d/box2d.h"
+#include "Constants.h"
+
+// =================================================================================================
+// CONTEXTO DE UNA RÉPLICA
+// =================================================================================================
+//
+// Una réplica es dueña de un mundo Box2D y de su estado de flujo/avalanchas y archivos de
+// salida. Ese estado vive en las variables thread_local de Constants.h / Initialization.h,
+// por lo que pertenece al hilo que ejecuta el contexto: réplicas en hilos distintos no
+// comparten contadores, archivos, RNG ni partículas. La contracara: un hilo auxiliar que lance
+// la réplica (AsyncWriter, workers de TaskScheduler, LeaseKeeper de la cola) no ve ni ese
+// estado ni la configuración de la réplica, sino su propia copia por defecto; todo lo que use
+// tiene que recibirlo explícitamente al crearse (TaskScheduler el número de hilos, LeaseKeeper
+// el TTL; AsyncWriter no lee nada). beginReplica y las entradas al escritor y al planificador
+// verifican con requireConfig() que el hilo que las llama haya recibido la configuración.
+
+struct SimulationContext {
+    int simulationIndex = 1;                 // Índice de la réplica (nombre del directorio de salida)
+    uint64_t seed = 0;                       // Semilla global (--seed); los flujos se derivan con el índice
+    b2WorldId worldId = b2_nullWorldId;      // Mundo de la réplica
+    b2BodyId outletBlockId = b2_nullBodyId;  // Tapa temporal del orificio durante la sedimentación
+    bool interrupted = false;                // Bloqueo persistente (MAX_BLOCKAGE_RETRIES)
+};
+
+/**
+ * Reinicia el estado thread_local del hilo actual y abre los archivos de la réplica.
+ */
+void beginReplica(SimulationContext& ctx);
+
+/**
+ * Escribe el resumen final, cierra los archivos y destruye el mundo de la réplica.
+ */
+void endReplica(SimulationContext& ctx);
+
+/**
+ * Ejecuta en este hilo la réplica simulationIndex con la configuración del hilo
+ * (beginReplica, body, endReplica).
+ */
+void runSingleReplica(int simulationIndex, const std::function<void(SimulationContext&)>& body);
+
+/**
+ * Ejecuta las réplicas firstIndex .. firstIndex+count-1. Con parallel > 1 se reparten
+ * dinámicamente entre `parallel` hilos, que heredan la configuración de este; con
+ * parallel <= 1 corren en serie en este hilo.
+ */
+void runReplicas(int firstIndex, int count, int parallel,
+                 const std::function<void(SimulationContext&)>& body);
+
+#endif // SIMULATIONCONTEXT_H
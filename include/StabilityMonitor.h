@@ -0,0 +1,65 @@
+// include/StabilityMonitor.h
+
+#ifndef STABILITYMONITOR_H
+#define STABILITYMONITOR_H
+
+#include <vector>
+#include "box2d/box2d.h"
+#include "Initialization.h"
+
+// =================================================================================================
+// MONITOR DE ESTABILIDAD (sedimentación, relax entre tandas, atascos)
+// =================================================================================================
+//
+// Decide si el empaquetamiento está quieto a partir de stateSnapshot, recorriendo sólo los
+// cuerpos despiertos (awakeList): un cuerpo dormido tiene velocidad nula, cuenta como lento y su
+// altura entra por sleepingMaxY(). Cada muestra cuesta O(despiertos) en lugar de O(N), y cuando
+// Box2D durmió a todos (quiescent) la respuesta es inmediata.
+
+struct StabilityCriteria {
+    float kePerParticle = 1e-3f;     // energía cinética media máxima
+    float keDelta       = -1.0f;     // |ΔE| máximo entre muestras (< 0: no se exige)
+    float vSlow         = 0.05f;     // umbrales de partícula "lenta"
+    float wSlow         = 0.2f;
+    float slowFraction  = 0.95f;     // fracción mínima de partículas lentas
+    float yCeiling      = 1e30f;     // altura máxima de los centros (banda de spawneo libre)
+};
+
+struct StabilitySample {
+    float kineticEnergy;
+    float kePerParticle;
+    float keDelta;
+    float slowFraction;
+    float yMax;
+    int   awakeCount;
+    bool  quiescent;     // ningún cuerpo despierto
+    bool  stable;        // cumple los criterios
+};
+
+class StabilityMonitor {
+public:
+    explicit StabilityMonitor(const StabilityCriteria& criteria = StabilityCriteria())
+        : criteria_(criteria) {}
+
+    // Olvida la energía de la muestra anterior
+    void reset() { prevKE_ = 1e9f; }
+
+    StabilitySample sample(const std::vector<ParticleInfo>& particles);
+
+    const StabilityCriteria& criteria() const { return criteria_; }
+
+private:
+    StabilityCriteria criteria_;
+    float prevKE_ = 1e9f;
+};
+
+// Criterio de sedimentación: defaults y techo de la banda de spawneo (2 Rmax bajo el tope)
+StabilityCriteria sedimentationCriteria();
+
+// Ninguna partícula despierta tras el último paso (O(1), sin recorrer cuerpos)
+bool particlesQuiescent();
+
+// Ningún cuerpo dinámico despierto en el mundo (contador de Box2D)
+bool worldQuiescent(b2WorldId worldId);
+
+#endif // STABILITYMONITOR_H
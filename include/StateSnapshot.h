@@ -0,0 +1,70 @@
+// include/StateSnapshot.h
+
+#ifndef STATESNAPSHOT_H
+#define STATESNAPSHOT_H
+
+#include "box2d/box2d.h"
+#include <cstdint>
+#include <vector>
+#include "Initialization.h"
+
+// =================================================================================================
+// FOTO DEL ESTADO DE LAS PARTÍCULAS (estructura de arreglos, una por réplica)
+// =================================================================================================
+//
+// Los observadores (criterios de estabilidad, salida de partículas, escritura de frames, paso
+// adaptativo) leen posiciones, rotaciones y velocidades de estos arreglos contiguos en lugar de
+// consultar cuerpo por cuerpo a Box2D. El índice i coincide con particles[i].
+//
+// Posiciones y rotaciones se actualizan en cada paso desde los eventos de movimiento de
+// b2World_GetBodyEvents (sólo cuerpos despiertos). Las velocidades se leen a pedido, una vez por
+// paso observado, y sólo de los cuerpos despiertos: un cuerpo dormido tiene velocidad nula.
+// Por eso todo b2World_Step de src_v2 pasa por stepWorld().
+//
+// awakeList es el conjunto despierto del último paso (los cuerpos con evento de movimiento que
+// no se durmieron): los observadores que sólo necesitan lo que se mueve recorren esa lista en
+// lugar de las N partículas. sleepingMaxY() es la altura máxima de los dormidos, mantenida con
+// los eventos (se recalcula completa sólo si se despierta el que la tenía).
+
+struct StateSnapshot {
+    std::vector<float>   x, y;           // posición del centro
+    std::vector<float>   cosA, sinA;     // rotación (b2Rot)
+    std::vector<float>   vx, vy, w;      // velocidad lineal y angular
+    std::vector<uint8_t> awake;          // 1 si el cuerpo se movió en el último paso (o no durmió aún)
+    std::vector<int>     awakeList;      // índices con awake = 1
+
+    size_t size() const { return x.size(); }
+    float  angle(size_t i) const;
+
+    // Lectura completa (todas las partículas); se usa al crear cuerpos nuevos
+    void captureAll(const std::vector<ParticleInfo>& particles);
+
+    // Actualiza posiciones/rotaciones con los eventos de movimiento del último paso
+    void applyMoveEvents(b2WorldId worldId);
+
+    // Velocidades de los cuerpos despiertos; no hace nada si ya se leyeron en este paso
+    void refreshVelocities(const std::vector<ParticleInfo>& particles);
+
+    // Teletransporte hecho por el programa (reinyección): mantiene la foto al día
+    void setPose(int i, b2Vec2 pos, b2Rot rot);
+
+    // Altura máxima de los cuerpos dormidos (-1e30 si no hay)
+    float sleepingMaxY();
+
+private:
+    void markAsleep(int i);
+    void markAwake(int i);
+
+    std::vector<int> prevAwake_;
+    bool  velocitiesFresh_ = false;
+    float sleepingMaxY_ = -1e30f;
+    bool  sleepingMaxDirty_ = true;
+};
+
+// Foto de la réplica en curso (una por hilo de réplica)
+extern thread_local StateSnapshot stateSnapshot;
+
+// b2World_Step + actualización de stateSnapshot con los eventos de movimiento
+void stepWorld(b2WorldId worldId, float dt, int subSteps);
+
+#endif // STATESNAPSHOT_H
@@ -0,0 +1,100 @@
+// include/TaskScheduler.h
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "box2d/box2d.h"
+
+// =================================================================================================
+// PLANIFICADOR DE TAREAS CON ROBO DE TRABAJO (callbacks de tareas de Box2D v3)
+// =================================================================================================
+//
+// Box2D v3 paraleliza b2World_Step si el b2WorldDef trae workerCount > 1 junto con
+// enqueueTask/finishTask. Cada tarea encolada se parte en bloques [start, end) que se
+// reparten entre las colas de los hilos; un hilo sin trabajo roba bloques de las colas
+// ajenas. El hilo que llama a b2World_Step actúa como worker 0 y colabora en finishTask.
+// Toda tarea pasa por las colas, aunque tenga un solo ítem: el solver de Box2D encola una
+// b2SolverTask de un ítem por worker y espera que corran a la vez en hilos distintos. Cada
+// hilo ejecuta con su propio índice de worker, así que el índice es único entre las tareas
+// en curso. Sólo se ejecuta en el hilo que llama si se agotan los grupos (MAX_TASKS).
+//
+// Un planificador atiende a un único mundo a la vez (los índices de worker son por mundo).
+
+class TaskScheduler {
+public:
+    explicit TaskScheduler(int workerCount);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    int workerCount() const { return workerCount_; }
+
+    // Bloques ejecutados por cada hilo desde que se creó el planificador (índice = worker)
+    std::vector<long long> itemsPerWorker() const;
+
+    /**
+     * Completa workerCount, enqueueTask, finishTask y userTaskContext del b2WorldDef.
+     * Con un solo hilo deja el b2WorldDef intacto (Box2D corre en serie).
+     */
+    void configureWorldDef(b2WorldDef& worldDef);
+
+private:
+    static constexpr int MAX_TASKS = 256;
+
+    struct TaskGroup {
+        b2TaskCallback* task = nullptr;
+        void* taskContext = nullptr;
+        std::atomic<int> remaining{0};
+    };
+
+    struct WorkItem {
+        TaskGroup* group;
+        int start;
+        int end;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<WorkItem> items;
+        std::atomic<long long> executed{0};   // bloques que ejecutó el dueño de la cola
+    };
+
+    static void* enqueueTask(b2TaskCallback* task, int itemCount, int minRange,
+                             void* taskContext, void* userContext);
+    static void finishTask(void* userTask, void* userContext);
+
+    bool popOrSteal(int workerIndex, WorkItem& out);
+    void execute(const WorkItem& item, int workerIndex);
+    void workerLoop(int workerIndex);
+
+    int workerCount_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    // Grupos de tareas reciclados por paso (solo los toca el hilo que llama a b2World_Step)
+    TaskGroup groups_[MAX_TASKS];
+    int taskCount_ = 0;
+    int outstandingTasks_ = 0;
+    int nextQueue_ = 0;          // cola del primer bloque de la próxima tarea (rota entre tareas)
+
+    std::atomic<int> pendingItems_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCondition_;
+};
+
+// Planificador del hilo actual (uno por hilo de réplica) con NUM_THREADS hilos. Si NUM_THREADS
+// cambió desde la última llamada (barrido con otro --threads) se rehace: se llama sólo al crear
+// un mundo, y todos los mundos de una réplica usan el mismo NUM_THREADS.
+TaskScheduler& defaultTaskScheduler();
+
+#endif // TASKSCHEDULER_H
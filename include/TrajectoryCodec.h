@@ -0,0 +1,61 @@
+// include/TrajectoryCodec.h
+
+#ifndef TRAJECTORYCODEC_H
+#define TRAJECTORYCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// =================================================================================================
+// CÓDEC DE TRAYECTORIAS (cuantización + delta + Rice adaptativo)
+// =================================================================================================
+//
+// Posiciones y ángulos se cuantizan con pasos fijos (posQuantum en m, angleQuantum en rad) y cada
+// frame guarda la diferencia entera con el frame anterior *reconstruido*, de modo que el error
+// nunca se acumula: |x - x̂| <= posQuantum/2 y |θ - θ̂| <= angleQuantum/2 en todo frame.
+// Los keyframes guardan los valores absolutos y permiten empezar a decodificar desde ellos.
+//
+// Los residuos (zigzag) se codifican con Golomb-Rice en bloques de BLOCK_VALUES valores con un
+// parámetro k por bloque. En un silo empaquetado casi todas las partículas se mueven menos que un
+// cuanto entre frames: el residuo es 0 y cuesta 1 bit.
+//
+// El ángulo reconstruido se devuelve envuelto en (-π, π], como b2Rot_GetAngle.
+
+namespace trajectory {
+
+class Encoder {
+public:
+    void configure(size_t particleCount, float posQuantum, float angleQuantum);
+
+    // Codifica un frame en out (se reemplaza el contenido). keyframe = valores absolutos.
+    void encode(const float* x, const float* y, const float* angle, bool keyframe,
+                std::vector<uint8_t>& out);
+
+private:
+    float posQuantum_ = 0.0f;
+    float angleQuantum_ = 0.0f;
+    std::vector<int64_t> qx_, qy_, qa_;       // último frame reconstruido, en cuantos
+    std::vector<uint64_t> residuals_;
+};
+
+class Decoder {
+public:
+    void configure(size_t particleCount, float posQuantum, float angleQuantum);
+
+    // Decodifica un frame; los frames no-keyframe deben llegar en orden desde el último keyframe.
+    // Devuelve false si el payload está truncado o corrupto.
+    bool decode(const uint8_t* data, size_t bytes, bool keyframe,
+                float* x, float* y, float* angle);
+
+private:
+    float posQuantum_ = 0.0f;
+    float angleQuantum_ = 0.0f;
+    std::vector<int64_t> qx_, qy_, qa_;
+    std::vector<uint64_t> residuals_;
+    bool primed_ = false;                     // hubo un keyframe desde configure()
+};
+
+} // namespace trajectory
+
+#endif // TRAJECTORYCODEC_H
@@ -0,0 +1,54 @@
+// include/WorkQueue.h
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "ParameterSweep.h"
+#include "SimulationContext.h"
+
+// =================================================================================================
+// COLA DE TRABAJO COMPARTIDA ENTRE NODOS (--sweep <dir|manifiesto> --queue-dir <dir>)
+// =================================================================================================
+//
+// Varios procesos silo_simulator (en uno o varios nodos con el mismo sistema de archivos)
+// corren el mismo barrido sin coordinador. Todos arman la misma lista de tareas
+// (archivo de parámetros, réplica) y se las reparten con archivos en el directorio de la cola:
+//
+//   <cola>/leases/<tarea>.lease   reserva: se crea con O_CREAT|O_EXCL, así que sólo un proceso
+//                                 la obtiene. Contiene el dueño (host.pid) y la hora. Mientras
+//                                 la tarea corre, un hilo renueva su fecha de modificación cada
+//                                 LEASE_TTL/4. Al terminar se borra sólo si el dueño sigue
+//                                 siendo este proceso.
+//   <cola>/done/<tarea>           marca de tarea terminada (se escribe aparte y se renombra).
+//
+// Una reserva sin renovar durante LEASE_TTL segundos (proceso caído) se considera vencida:
+// otro proceso la aparta con rename y la vuelve a crear. Como el rename se lleva lo que haya en
+// ese camino, después se confirma que lo apartado sea la misma reserva vencida (mismo
+// contenido, sin renovar); si era la reserva nueva de otro proceso que ganó antes, se devuelve
+// a su lugar. Al tomar una reserva vencida se borran los directorios de preparación de su
+// dueño para esa tarea. LEASE_TTL debe superar el desfase de relojes entre nodos.
+//
+// La réplica escribe en ./simulations/.staging/<tarea>.<host>.<pid>.<hilo>/ y al terminar se
+// publica renombrando ese directorio al de initializeDataFiles. Después se escribe la marca y
+// se libera la reserva. Si una reserva vencida se roba a un proceso que en realidad seguía
+// vivo, la tarea se corre dos veces: si al publicar ya existe done/<tarea>, el resultado
+// duplicado se descarta. Si el destino existe pero no hay marca, no se da por publicado: se
+// aparta a <destino>.previo.<dueño>.<ms> y se reintenta el rename (si tampoco se puede, la
+// tarea queda sin publicar y sin marca). Nunca quedan archivos mezclados ni se borra nada que
+// no esté confirmado.
+//
+// Un proceso termina cuando todas las tareas tienen marca; mientras queden tareas reservadas
+// por otros, espera y vuelve a revisar (por si vencen). Para probarlo en una sola máquina
+// alcanza con lanzar varios procesos con el mismo --sweep y --queue-dir.
+
+/**
+ * Corre las tareas del barrido que consiga reservar en queueDir, en `workers` hilos.
+ * Devuelve false si la cola no se pudo preparar.
+ */
+bool runQueuedSweep(const std::vector<SweepSet>& sets, int workers, const std::string& queueDir,
+                    const std::function<void(SimulationContext&)>& body);
+
+#endif // WORKQUEUE_H
@@ -94,7 +94,7 @@ SIMULATION_DIRS=(
 FOUND_SIM=""
 for pattern in "${SIMULATION_DIRS[@]}"; do
   for dir in $pattern; do
-    if [[ -d "$dir" && -f "$dir/simulation_data.csv" ]]; then
+    if [[ -d "$dir" && ( -f "$dir/simulation_data.csv" || -f "$dir/simulation_data.bin" ) ]]; then
       FOUND_SIM="$dir"
       break 2
     fi
@@ -105,7 +105,7 @@ done
 if [[ -z "$FOUND_SIM" ]]; then
   echo -e "${YELLOW}No se encontró por patrón; buscando la simulación más reciente...${NC}"
   RECENT_SIM=$(find ./simulations/ ./data/simulations/ ./examples/simulations/ ./tests/simulations/ \
-               -name "simulation_data.csv" -type f 2>/dev/null | sort -r | head -1)
+               \( -name "simulation_data.csv" -o -name "simulation_data.bin" \) -type f 2>/dev/null | sort -r | head -1)
   [[ -n "$RECENT_SIM" ]] && FOUND_SIM=$(dirname "$RECENT_SIM")
 fi
 
@@ -118,6 +118,17 @@ fi
 echo -e "${GREEN}Simulación encontrada: $FOUND_SIM${NC}"
 
 DATA_FILE="$FOUND_SIM/simulation_data.csv"
+
+# Frames en binario (simulation_data.bin): el renderer los lee con bin/frames_extract,
+# que decodifica sólo el rango y el salto de frames pedidos
+if [[ ! -f "$DATA_FILE" && -f "$FOUND_SIM/simulation_data.bin" ]]; then
+  DATA_FILE="$FOUND_SIM/simulation_data.bin"
+  if [[ ! -x ./bin/frames_extract ]]; then
+    echo -e "${YELLOW}Compilando lector de frames (make tools)...${NC}"
+    make tools >/dev/null
+  fi
+fi
+
 if [[ ! -f "$DATA_FILE" ]]; then
   echo -e "${RED}Error: falta $DATA_FILE${NC}"; exit 1
 fi
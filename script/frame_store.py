@@ -0,0 +1,53 @@
+"""
+Acceso a simulation_data.bin desde los renderers.
+
+La lectura la hace bin/frames_extract (C++, archivo mapeado en memoria): sólo se decodifican los
+frames del rango pedido y llegan por un pipe con el mismo formato que el CSV histórico, así que
+el parser de cada renderer no cambia. Los .csv se siguen abriendo directamente.
+"""
+import contextlib
+import os
+import subprocess
+
+_REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FRAMES_EXTRACT = os.environ.get('FRAMES_EXTRACT', os.path.join(_REPO_DIR, 'bin', 'frames_extract'))
+
+
+def is_frame_store(path):
+    return str(path).endswith('.bin')
+
+
+def _time_args(min_time, max_time):
+    args = []
+    if min_time is not None and min_time != float('-inf'):
+        args += ['--min-time', repr(float(min_time))]
+    if max_time is not None and max_time != float('inf'):
+        args += ['--max-time', repr(float(max_time))]
+    return args
+
+
+def count_frames(path, min_time=None, max_time=None):
+    """(frames, t_inicial, t_final) del rango, leído del índice sin decodificar frames."""
+    out = subprocess.run([FRAMES_EXTRACT, path, '--count'] + _time_args(min_time, max_time),
+                         check=True, capture_output=True, text=True).stdout.split()
+    return int(out[0]), float(out[1]), float(out[2])
+
+
+@contextlib.contextmanager
+def open_frame_source(path, min_time=None, max_time=None, frame_step=1):
+    """
+    Iterable de líneas CSV (header incluido). Para un .bin el rango y el salto de frames los
+    aplica frames_extract; el llamador NO debe volver a saltear frames (usar frame_step=1).
+    """
+    if not is_frame_store(path):
+        with open(path, 'r', newline='') as f:
+            yield f
+        return
+
+    cmd = [FRAMES_EXTRACT, path] + _time_args(min_time, max_time) + ['--frame-step', str(max(1, int(frame_step)))]
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, text=True, bufsize=1 << 20)
+    try:
+        yield proc.stdout
+    finally:
+        proc.stdout.close()
+        proc.wait()
@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Regresión de rendimiento y de física contra corridas de referencia ("golden").
+
+Corre un conjunto fijo de configuraciones de run/discos y run/cuadrados con semilla fija (una
+réplica cada una, con MAX_AVALANCHES acotado) y para cada una registra:
+  - rendimiento: tiempo de pared, pasos/s de la fase de flujo y pico de memoria (RSS);
+  - física: tamaños de avalancha (avalanche_data.csv), caudal por avalancha y caudal medio,
+    y caudal medio de flow_data.csv.
+
+Compara contra regression/golden/<nombre>.json y falla (código 1) si:
+  - los tamaños de avalancha difieren según Kolmogorov-Smirnov de dos muestras (p < alpha);
+  - el caudal por avalancha difiere según el test t de Welch (p < alpha);
+  - el caudal medio se aparta más de --flow-tol (relativo);
+  - los pasos/s caen o el tiempo de pared sube más de --perf-tol, o el RSS sube más de --rss-tol.
+
+Termina con código 2 si falta el binario o alguna golden: es un error de preparación, no una
+regresión. Las golden no vienen en el repo; se generan una vez por máquina con --update-golden.
+
+Uso:
+  make regression                                      # compila bin/silo_simulator_v2 y compara
+  python3 script/regression.py                         # compara contra las golden
+  python3 script/regression.py --update-golden         # regenera las golden (revisar el diff)
+  python3 script/regression.py --only discos --skip-perf
+  # A/B de una opción: golden sin ella, comparación con el valor por defecto
+  python3 script/regression.py --update-golden --set JAM_CONFIRM_TIME=0
+  python3 script/regression.py --skip-perf
+
+El rendimiento depende de la máquina: las golden guardan el host y se avisa si no coincide.
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+REPO_DIR = Path(__file__).resolve().parent.parent
+GOLDEN_DIR = REPO_DIR / "regression" / "golden"
+
+# Configuraciones de referencia: (nombre, archivo de parámetros)
+REFERENCIAS = [
+    ("discos_p1", "run/discos/param_files/parametros_1.txt"),
+    ("cuadrados_p1", "run/cuadrados/param_files/parametros_1.txt"),
+]
+
+# Se agregan al final del archivo (la última clave gana): una réplica, semilla y largo fijos
+OVERRIDES = {
+    "CURRENT_SIM": "1",
+    "TOTAL_SIMS": "1",
+    "SAVE_SIM_DATA": "0",
+    "SEED": "20240601",
+    "THREADS": "1",
+    "PARALLEL_REPLICAS": "1",
+    "MAX_AVALANCHES": "30",
+}
+
+MIN_AVALANCHAS = 5
+PARED_HOLGURA_S = 1.0      # diferencias de pared menores no cuentan (arranque del proceso)
+
+RE_RENDIMIENTO = re.compile(r"Rendimiento flujo: (\d+) pasos en ([\d.]+) s = ([\d.]+) pasos/s")
+
+
+# -----------------------------
+# Estadística (sin dependencias)
+# -----------------------------
+
+def ks_2samp(a, b):
+    """Kolmogorov-Smirnov de dos muestras: (D, p) con la distribución asintótica."""
+    a, b = sorted(a), sorted(b)
+    n, m = len(a), len(b)
+    i = j = 0
+    d = 0.0
+    while i < n and j < m:
+        x = min(a[i], b[j])
+        while i < n and a[i] <= x:
+            i += 1
+        while j < m and b[j] <= x:
+            j += 1
+        d = max(d, abs(i / n - j / m))
+    en = math.sqrt(n * m / (n + m))
+    lam = (en + 0.12 + 0.11 / en) * d
+    if lam < 1e-3:
+        return d, 1.0
+    p = 0.0
+    for k in range(1, 101):
+        term = 2.0 * (-1) ** (k - 1) * math.exp(-2.0 * k * k * lam * lam)
+        p += term
+        if abs(term) < 1e-10:
+            break
+    return d, min(1.0, max(0.0, p))
+
+
+def _betacf(a, b, x):
+    """Fracción continua de la beta incompleta (Numerical Recipes)."""
+    tiny = 1e-300
+    qab, qap, qam = a + b, a + 1.0, a - 1.0
+    c, d = 1.0, 1.0 - qab * x / qap
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    h = d
+    for m in range(1, 301):
+        m2 = 2 * m
+        aa = m * (b - m) * x / ((qam + m2) * (a + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > tiny else tiny)
+        c = 1.0 + aa / c if abs(1.0 + aa / c) > tiny else tiny
+        h *= d * c
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2))
+        d = 1.0 + aa * d
+        d = 1.0 / (d if abs(d) > tiny else tiny)
+        c = 1.0 + aa / c if abs(1.0 + aa / c) > tiny else tiny
+        delta = d * c
+        h *= delta
+        if abs(delta - 1.0) < 1e-12:
+            break
+    return h
+
+
+def betainc(a, b, x):
+    """Beta incompleta regularizada I_x(a, b)."""
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    lbeta = math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b)
+    front = math.exp(lbeta + a * math.log(x) + b * math.log(1.0 - x))
+    if x < (a + 1.0) / (a + b + 2.0):
+        return front * _betacf(a, b, x) / a
+    return 1.0 - front * _betacf(b, a, 1.0 - x) / b
+
+
+def welch_ttest(a, b):
+    """Test t de Welch de dos colas: (t, p)."""
+    n, m = len(a), len(b)
+    ma, mb = sum(a) / n, sum(b) / m
+    va = sum((x - ma) ** 2 for x in a) / (n - 1)
+    vb = sum((x - mb) ** 2 for x in b) / (m - 1)
+    se2 = va / n + vb / m
+    if se2 <= 0.0:
+        return 0.0, (1.0 if ma == mb else 0.0)
+    t = (ma - mb) / math.sqrt(se2)
+    df = se2 ** 2 / ((va / n) ** 2 / (n - 1) + (vb / m) ** 2 / (m - 1))
+    return t, betainc(df / 2.0, 0.5, df / (df + t * t))
+
+
+# -----------------------------
+# Corrida
+# -----------------------------
+
+def leer_avalanchas(ruta):
+    """(tamaños, duraciones) de las filas 'Avalancha N,inicio,fin,duración,partículas'."""
+    tamanos, duraciones = [], []
+    with open(ruta, encoding="utf-8", errors="replace") as f:
+        for linea in f:
+            if not linea.startswith("Avalancha "):
+                continue
+            campos = linea.strip().split(",")
+            duraciones.append(float(campos[3]))
+            tamanos.append(int(campos[4]))
+    return tamanos, duraciones
+
+
+def caudal_flow_data(ruta):
+    """Caudal medio (partículas/s) de flow_data.csv en los intervalos con salidas."""
+    tasas = []
+    with open(ruta, encoding="utf-8") as f:
+        cabecera = f.readline().strip().split(",")
+        col = cabecera.index("NoPFlowRate")
+        for linea in f:
+            campos = linea.strip().split(",")
+            if len(campos) > col:
+                tasa = float(campos[col])
+                if tasa > 0.0:
+                    tasas.append(tasa)
+    return sum(tasas) / len(tasas) if tasas else 0.0
+
+
+def correr(nombre, archivo, binario, verbose):
+    trabajo = Path(tempfile.mkdtemp(prefix=f"regresion_{nombre}_"))
+    try:
+        parametros = trabajo / "parametros.txt"
+        texto = (REPO_DIR / archivo).read_text(encoding="utf-8")
+        texto += "\n# Regresión\n" + "".join(f"{k}={v}\n" for k, v in OVERRIDES.items())
+        parametros.write_text(texto, encoding="utf-8")
+        (trabajo / "manifiesto.txt").write_text("parametros.txt\n", encoding="utf-8")
+
+        inicio = time.monotonic()
+        proc = subprocess.Popen([str(binario), "--sweep", "manifiesto.txt"], cwd=trabajo,
+                                stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        salida = []
+        for linea in proc.stdout:
+            salida.append(linea)
+            if verbose:
+                sys.stdout.write(linea)
+        _, estado, uso = os.wait4(proc.pid, 0)
+        proc.returncode = os.waitstatus_to_exitcode(estado)
+        pared = time.monotonic() - inicio
+        if proc.returncode != 0:
+            sys.stdout.write("".join(salida[-40:]))
+            raise RuntimeError(f"{nombre}: silo_simulator terminó con código {proc.returncode}")
+
+        m = RE_RENDIMIENTO.search("".join(salida))
+        dirs = sorted((trabajo / "simulations").glob("sim_*"))
+        if not m or not dirs:
+            raise RuntimeError(f"{nombre}: no se encontró el resultado de la corrida en {trabajo}")
+
+        tamanos, duraciones = leer_avalanchas(dirs[0] / "avalanche_data.csv")
+        return {
+            "nombre": nombre,
+            "archivo": archivo,
+            "overrides": OVERRIDES,
+            "host": socket.gethostname(),
+            "rendimiento": {
+                "pared_s": pared,
+                "pasos_flujo": int(m.group(1)),
+                "pasos_por_s": float(m.group(3)),
+                "rss_max_mb": uso.ru_maxrss / 1024.0,
+            },
+            "fisica": {
+                "avalanchas": len(tamanos),
+                "tamanos": tamanos,
+                "duraciones": duraciones,
+                "caudal_por_avalancha": [t / d for t, d in zip(tamanos, duraciones) if d > 0],
+                "caudal_medio": sum(tamanos) / sum(duraciones) if sum(duraciones) > 0 else 0.0,
+                "caudal_flow_data": caudal_flow_data(dirs[0] / "flow_data.csv"),
+            },
+        }
+    finally:
+        shutil.rmtree(trabajo, ignore_errors=True)
+
+
+# -----------------------------
+# Comparación
+# -----------------------------
+
+def comparar(actual, golden, args):
+    """Lista de (chequeo, ok, detalle)."""
+    res = []
+    fa, fg = actual["fisica"], golden["fisica"]
+
+    if fa["avalanchas"] < MIN_AVALANCHAS or fg["avalanchas"] < MIN_AVALANCHAS:
+        res.append(("avalanchas", False,
+                    f"muestras insuficientes ({fa['avalanchas']} vs golden {fg['avalanchas']}, "
+                    f"mínimo {MIN_AVALANCHAS})"))
+    else:
+        d, p = ks_2samp(fa["tamanos"], fg["tamanos"])
+        res.append(("tamaños KS", p >= args.alpha, f"D={d:.3f} p={p:.4f} (alpha {args.alpha})"))
+        t, p = welch_ttest(fa["caudal_por_avalancha"], fg["caudal_por_avalancha"])
+        res.append(("caudal Welch", p >= args.alpha, f"t={t:.3f} p={p:.4f} (alpha {args.alpha})"))
+
+    for clave in ("caudal_medio", "caudal_flow_data"):
+        g = fg[clave]
+        rel = abs(fa[clave] - g) / g if g > 0 else float("inf")
+        res.append((clave, rel <= args.flow_tol,
+                    f"{fa[clave]:.2f} vs {g:.2f} p/s ({100 * rel:+.1f}%, tol {100 * args.flow_tol:.0f}%)"))
+
+    if not args.skip_perf:
+        ra, rg = actual["rendimiento"], golden["rendimiento"]
+        cambio = ra["pasos_por_s"] / rg["pasos_por_s"] - 1.0
+        res.append(("pasos/s", cambio >= -args.perf_tol,
+                    f"{ra['pasos_por_s']:.1f} vs {rg['pasos_por_s']:.1f} ({100 * cambio:+.1f}%)"))
+        cambio = ra["pared_s"] / rg["pared_s"] - 1.0
+        holgura = ra["pared_s"] - rg["pared_s"] <= max(args.perf_tol * rg["pared_s"], PARED_HOLGURA_S)
+        res.append(("tiempo de pared", holgura,
+                    f"{ra['pared_s']:.1f} vs {rg['pared_s']:.1f} s ({100 * cambio:+.1f}%)"))
+        cambio = ra["rss_max_mb"] / rg["rss_max_mb"] - 1.0
+        res.append(("RSS máx.", cambio <= args.rss_tol,
+                    f"{ra['rss_max_mb']:.1f} vs {rg['rss_max_mb']:.1f} MB ({100 * cambio:+.1f}%)"))
+    return res
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Regresión de rendimiento y física con corridas golden")
+    ap.add_argument("--binary", default=str(REPO_DIR / "bin" / "silo_simulator_v2"))
+    ap.add_argument("--update-golden", action="store_true", help="Regenera las golden con esta corrida")
+    ap.add_argument("--only", default="", help="Sólo las referencias cuyo nombre contenga este texto")
+    ap.add_argument("--alpha", type=float, default=0.01, help="Nivel de los tests (default 0.01)")
+    ap.add_argument("--flow-tol", type=float, default=0.10, help="Desvío relativo del caudal medio")
+    ap.add_argument("--perf-tol", type=float, default=0.15, help="Caída de pasos/s / suba de pared")
+    ap.add_argument("--rss-tol", type=float, default=0.20, help="Suba relativa del RSS máximo")
+    ap.add_argument("--skip-perf", action="store_true", help="Sólo física (otra máquina, CI ruidoso)")
+    ap.add_argument("--report", default="", help="Guarda el resultado completo en este JSON")
+    ap.add_argument("--verbose", action="store_true", help="Muestra la salida del simulador")
+    ap.add_argument("--set", action="append", default=[], metavar="CLAVE=VALOR",
+                    help="Agrega un parámetro a los overrides (repetible), p. ej. para un A/B")
+    args = ap.parse_args()
+    for asignacion in args.set:
+        clave, igual, valor = asignacion.partition("=")
+        if not igual or not clave:
+            print(f"[ERROR] --set espera CLAVE=VALOR: {asignacion}")
+            return 2
+        OVERRIDES[clave.strip()] = valor.strip()
+
+    binario = Path(args.binary).resolve()
+    if not binario.is_file():
+        print(f"[ERROR] No se encontró el binario {binario} (make bin/silo_simulator_v2)")
+        return 2
+
+    referencias = [(n, a) for n, a in REFERENCIAS if args.only in n]
+    if not args.update_golden:
+        faltantes = [n for n, _ in referencias if not (GOLDEN_DIR / f"{n}.json").exists()]
+        if faltantes:
+            print(f"[ERROR] Faltan golden en {GOLDEN_DIR.relative_to(REPO_DIR)}: {', '.join(faltantes)}")
+            print("        Generarlas con --update-golden (make regression "
+                  "REGRESSION_ARGS=--update-golden) y revisarlas antes de comparar.")
+            return 2
+    GOLDEN_DIR.mkdir(parents=True, exist_ok=True)
+    fallas = []
+    reporte = []
+
+    for nombre, archivo in referencias:
+        print(f"=== {nombre} ({archivo}) ===", flush=True)
+        actual = correr(nombre, archivo, binario, args.verbose)
+        r = actual["rendimiento"]
+        print(f"  {actual['fisica']['avalanchas']} avalanchas | {r['pasos_por_s']:.1f} pasos/s | "
+              f"{r['pared_s']:.1f} s | {r['rss_max_mb']:.1f} MB")
+
+        ruta_golden = GOLDEN_DIR / f"{nombre}.json"
+        if args.update_golden:
+            ruta_golden.write_text(json.dumps(actual, indent=2, ensure_ascii=False) + "\n", encoding="utf-8")
+            print(f"  golden actualizada: {ruta_golden.relative_to(REPO_DIR)}")
+            reporte.append({"actual": actual})
+            continue
+
+        golden = json.loads(ruta_golden.read_text(encoding="utf-8"))
+        if golden.get("overrides") != OVERRIDES:
+            print("  [AVISO] la golden se generó con otros overrides; regenerarla")
+        if not args.skip_perf and golden.get("host") != actual["host"]:
+            print(f"  [AVISO] golden de otro host ({golden.get('host')}); el rendimiento no es comparable")
+
+        chequeos = comparar(actual, golden, args)
+        for chequeo, ok, detalle in chequeos:
+            print(f"  {'ok   ' if ok else 'FALLA'} {chequeo:<18} {detalle}")
+            if not ok:
+                fallas.append((nombre, chequeo, detalle))
+        reporte.append({"actual": actual,
+                        "chequeos": [{"chequeo": c, "ok": ok, "detalle": d} for c, ok, d in chequeos]})
+
+    if args.report:
+        Path(args.report).write_text(json.dumps(reporte, indent=2, ensure_ascii=False) + "\n", encoding="utf-8")
+
+    if fallas:
+        print("\n" + "!" * 72)
+        print(f"!!! REGRESIÓN: {len(fallas)} chequeo(s) fuera de tolerancia")
+        for nombre, chequeo, detalle in fallas:
+            print(f"!!!   {nombre}: {chequeo}: {detalle}")
+        print("!" * 72)
+        return 1
+    print("\nSin regresiones." if not args.update_golden else "\nGolden actualizadas.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -12,6 +12,7 @@ from tqdm import tqdm
 import traceback
 import math
 import re
+from frame_store import is_frame_store, count_frames, open_frame_source
 
 class SiloRenderer:
     def __init__(self, width=1920, height=2560,
@@ -438,7 +439,14 @@ def load_simulation_data(file_path, min_time=-1.0, max_time=float('inf'), frame_
     frames = []
     frame_count = 0
 
-    with open(file_path, 'r') as f:
+    # simulation_data.bin: el rango y el salto de frames los aplica frames_extract
+    if is_frame_store(file_path):
+        source = open_frame_source(file_path, min_time, max_time, frame_step)
+        frame_step = 1
+    else:
+        source = open(file_path, 'r')
+
+    with source as f:
         # Leer header y detectar cuántas partículas hay en el header (si aparece p{n}_x)
         header_line = f.readline()
         header_parts = header_line.strip().split(',')
@@ -636,31 +644,38 @@ def main():
             sim_start_time = None
             sim_end_time = None
 
-            with open(args.data_path, 'r') as f:
-                header_skipped = False
-                for line in f:
-                    if not header_skipped:
-                        header_skipped = True
-                        continue
-
-                    parts = line.strip().split(',')
-                    if not parts:
-                        continue
-
-                    try:
-                        current_time = float(parts[0])
-                    except ValueError:
-                        continue
-
-                    if current_time < args.min_time:
-                        continue
-                    if current_time > args.max_time:
-                        break
-
-                    if sim_start_time is None:
-                        sim_start_time = current_time
-                    sim_end_time = current_time
-                    total_frames += 1
+            if is_frame_store(args.data_path):
+                # Del índice del .bin, sin recorrer los frames
+                total_frames, sim_start_time, sim_end_time = count_frames(
+                    args.data_path, args.min_time, args.max_time)
+                if total_frames == 0:
+                    sim_start_time = sim_end_time = None
+            else:
+                with open(args.data_path, 'r') as f:
+                    header_skipped = False
+                    for line in f:
+                        if not header_skipped:
+                            header_skipped = True
+                            continue
+
+                        parts = line.strip().split(',')
+                        if not parts:
+                            continue
+
+                        try:
+                            current_time = float(parts[0])
+                        except ValueError:
+                            continue
+
+                        if current_time < args.min_time:
+                            continue
+                        if current_time > args.max_time:
+                            break
+
+                        if sim_start_time is None:
+                            sim_start_time = current_time
+                        sim_end_time = current_time
+                        total_frames += 1
 
             if total_frames > 0 and sim_start_time is not None and sim_end_time is not None:
                 sim_duration = sim_end_time - sim_start_time
@@ -6,6 +6,7 @@ import math
 import argparse
 import subprocess
 import traceback
+from frame_store import is_frame_store, count_frames, open_frame_source
 from tqdm import tqdm
 
 # --- backend arrays -----------------------------------------------------------
@@ -363,7 +364,17 @@ def load_simulation_data(file_path, xp,
     frames = []
     idx = 0
 
-    with open(file_path, 'r', newline='') as f:
+    # simulation_data.bin: frames_extract aplica el rango y el salto (con intervals, sólo decodifica)
+    if is_frame_store(file_path):
+        if intervals:
+            source = open_frame_source(file_path)
+        else:
+            source = open_frame_source(file_path, min_time, max_time, frame_step)
+            frame_step = 1
+    else:
+        source = open(file_path, 'r', newline='')
+
+    with source as f:
         reader = csv.reader(f)
         header = next(reader, None)
         if header is None:
@@ -650,27 +661,34 @@ def main():
             total_frames = 0
             sim_start_time = None
             sim_end_time = None
-            with open(args.data_path, 'r') as f:
-                header_skipped = False
-                for line in f:
-                    if not header_skipped:
-                        header_skipped = True
-                        continue
-                    parts = line.strip().split(',')
-                    if not parts:
-                        continue
-                    try:
-                        current_time = float(parts[0])
-                    except ValueError:
-                        continue
-                    if current_time < args.min_time:
-                        continue
-                    if current_time > args.max_time:
-                        break
-                    if sim_start_time is None:
-                        sim_start_time = current_time
-                    sim_end_time = current_time
-                    total_frames += 1
+            if is_frame_store(args.data_path):
+                # Del índice del .bin, sin recorrer los frames
+                total_frames, sim_start_time, sim_end_time = count_frames(
+                    args.data_path, args.min_time, args.max_time)
+                if total_frames == 0:
+                    sim_start_time = sim_end_time = None
+            else:
+                with open(args.data_path, 'r') as f:
+                    header_skipped = False
+                    for line in f:
+                        if not header_skipped:
+                            header_skipped = True
+                            continue
+                        parts = line.strip().split(',')
+                        if not parts:
+                            continue
+                        try:
+                            current_time = float(parts[0])
+                        except ValueError:
+                            continue
+                        if current_time < args.min_time:
+                            continue
+                        if current_time > args.max_time:
+                            break
+                        if sim_start_time is None:
+                            sim_start_time = current_time
+                        sim_end_time = current_time
+                        total_frames += 1
 
             if total_frames > 0 and sim_start_time is not None and sim_end_time is not None:
                 sim_duration = sim_end_time - sim_start_time
@@ -1,6 +1,7 @@
 // src/Initialization.cpp
 #include "Initialization.h"
 #include "Constants.h"
+#include "TaskScheduler.h"
 #include <iostream>
 #include <string>
 #include <cmath>
@@ -17,9 +18,9 @@
 // =========================================================
 // DEFINICIÓN E INICIALIZACIÓN DE VARIABLES GLOBALES DE ESTE MÓDULO
 // =========================================================
-b2WorldId worldId = b2_nullWorldId;
-std::vector<ParticleInfo> particles;
-std::vector<b2BodyId> particleBodyIds;
+thread_local b2WorldId worldId = b2_nullWorldId;
+thread_local std::vector<ParticleInfo> particles;
+thread_local std::vector<b2BodyId> particleBodyIds;
 
 // =========================================================
 // IMPLEMENTACIÓN DE LAS FUNCIONES DEL MÓDULO
@@ -85,6 +86,15 @@ bool parseAndValidateArgs(int argc, char** argv) {
         else if (strcmp(argv[i], "--max-avalanches") == 0 && i + 1 < argc) {
             MAX_AVALANCHES = std::stoi(argv[++i]);
         }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            NUM_THREADS = std::max(1, std::stoi(argv[++i]));
+        }
+        else {
+            // Flags de src_v2 (--sweep, --seed, ...) o valor faltante: no se ignoran en silencio
+            std::cerr << "Error: opción no soportada por esta versión: " << argv[i]
+                      << " (compilar src_v2 con make)\n";
+            return false;
+        }
     }
 
     if (REINJECT_HEIGHT_RATIO < 0.1f || REINJECT_HEIGHT_RATIO > 12.0f) {
@@ -207,6 +217,8 @@ b2WorldId createWorldAndWalls(b2BodyId& outletBlockIdRef) {
     // Configurar mundo Box2D
     b2WorldDef worldDef = b2DefaultWorldDef();
     worldDef.gravity = (b2Vec2){0.0f, -9.81f};
+    // Paso multihilo (--threads N): callbacks de tareas del planificador con robo de trabajo
+    defaultTaskScheduler().configureWorldDef(worldDef);
     b2WorldId newWorldId = b2CreateWorld(&worldDef);
 
     worldId = newWorldId;
@@ -394,7 +406,7 @@ void createParticles(b2WorldId worldId) {
     std::cout << "Generación completada: " << TOTAL_PARTICLES << " partículas con distribución y orientación aleatorias\n\n";
 }
 
-void runSedimentation(b2WorldId worldId) {
+bool runSedimentation(b2WorldId worldId) {
 
     std::cout << "Dejando que " << TOTAL_PARTICLES << " partículas se sedimenten por gravedad\n";
 
@@ -445,4 +457,6 @@ void runSedimentation(b2WorldId worldId) {
     if (!sedimentationComplete) {
         std::cout << "Estabilización finalizada por timeout después de " << MAX_SEDIMENTATION_TIME << " segundos\n";
     }
+
+    return sedimentationComplete;
 }
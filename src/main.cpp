@@ -16,6 +16,7 @@
 #include <set>
 #include <cstdint>
 #include <tuple>
+#include <chrono>
 
 #include "Constants.h"
 #include "Initialization.h"
@@ -59,6 +60,7 @@ int main(int argc, char** argv) {
     std::cout << "Altura del silo: " << silo_height << " m\n";
     std::cout << "Abertura del silo: " << OUTLET_WIDTH << " m (" << (OUTLET_WIDTH / (2 * BASE_RADIUS)) << " diámetros base)\n";
     std::cout << "Máximo de avalanchas: " << MAX_AVALANCHES << "\n";
+    std::cout << "Hilos (b2World_Step): " << NUM_THREADS << "\n";
     std::cout << "Simulación Actual: " << CURRENT_SIMULATION << " / " << TOTAL_SIMULATIONS << "\n";
 
     // 5. Bucle de Simulaciones 
@@ -87,6 +89,12 @@ int main(int argc, char** argv) {
         int exitedOriginalCount = 0;
         float exitedOriginalMass = 0.0f;
         float timeSinceLastExit = 0.0f;
+
+        // Rendimiento de la fase de flujo (pasos/s de reloj de pared)
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point flowWallStart = Clock::now();
+        Clock::time_point lastReportWall = flowWallStart;
+        long long flowSteps = 0, lastReportSteps = 0;
         
         // 10. BUCLE PRINCIPAL DE SIMULACIÓN
         while (avalancheCount < MAX_AVALANCHES && !simulationInterrupted) {
@@ -95,6 +103,7 @@ int main(int argc, char** argv) {
             b2World_Step(worldId, TIME_STEP, SUB_STEP_COUNT);
             simulationTime += TIME_STEP;
             frameCounter++;
+            flowSteps++;
 
             // Aplicar impulsos aleatorios
             //applyRandomImpulses(); 
@@ -121,11 +130,17 @@ int main(int argc, char** argv) {
             // Información periódica 
             if (simulationTime - lastPrintTime >= 5.0f) {
                 std::string currentState = inAvalanche ? "AVALANCHA" : (inBlockage ? "BLOQUEO" : "INICIAL");
+                const Clock::time_point now = Clock::now();
+                const double wall = std::chrono::duration<double>(now - lastReportWall).count();
+                const double stepsPerSec = (wall > 0.0) ? (flowSteps - lastReportSteps) / wall : 0.0;
                 std::cout << "Tiempo: " << std::fixed << std::setprecision(2) << simulationTime
                           << "s, Partículas Salientes: " << totalExitedParticles
                           << ", Avalanchas: " << avalancheCount << "/" << MAX_AVALANCHES
-                          << ", Estado: " << currentState << "\n";
+                          << ", Estado: " << currentState
+                          << ", Pasos/s: " << std::setprecision(1) << stepsPerSec << "\n";
                 lastPrintTime = simulationTime;
+                lastReportWall = now;
+                lastReportSteps = flowSteps;
             }
 
             // Guardado de datos detallados 
@@ -141,6 +156,12 @@ int main(int argc, char** argv) {
                 simulationDataFile << "\n";
             }
         }
+
+        const double flowWall = std::chrono::duration<double>(Clock::now() - flowWallStart).count();
+        std::cout << "Rendimiento flujo: " << flowSteps << " pasos en "
+                  << std::fixed << std::setprecision(2) << flowWall << " s = "
+                  << std::setprecision(1) << ((flowWall > 0.0) ? flowSteps / flowWall : 0.0)
+                  << " pasos/s (" << NUM_THREADS << " hilos)\n";
         
         // 11. Finalización de Archivos y Mundo (global)
         finalizeDataFiles(simulationInterrupted);
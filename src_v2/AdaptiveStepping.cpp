@@ -0,0 +1,115 @@
+// src/AdaptiveStepping.cpp
+
+#include "AdaptiveStepping.h"
+#include "StateSnapshot.h"
+#include <algorithm>
+#include <cmath>
+
+// =========================================================
+// INICIALIZACIÓN
+// =========================================================
+
+void AdaptiveStepController::reset(b2WorldId worldId, const std::vector<ParticleInfo>& particles) {
+    // Radio mínimo: discos por su radio, polígonos por su inradio (R cos(pi/n))
+    minRadius_ = 1e30f;
+    for (const auto& p : particles) {
+        float r = p.size;
+        if (p.shapeType == POLYGON && p.numSides >= 3) {
+            r = p.size * std::cos(float(M_PI) / p.numSides);
+        }
+        minRadius_ = std::min(minRadius_, r);
+    }
+    if (minRadius_ >= 1e30f) minRadius_ = BASE_RADIUS;
+
+    // Subpaso de seguridad: partiendo del reposo, la gravedad desplaza g h^2 en un subpaso, que
+    // no debe superar el mismo límite de desplazamiento que la velocidad (ADAPTIVE_CFL * radio
+    // mínimo). --max-substep lo puede achicar.
+    const b2Vec2 g = b2World_GetGravity(worldId);
+    const float gravity = std::max(1e-6f, std::sqrt(g.x * g.x + g.y * g.y));
+    maxSubStep_ = std::sqrt(ADAPTIVE_CFL * minRadius_ / gravity);
+    if (ADAPTIVE_MAX_SUBSTEP > 0.0f) maxSubStep_ = std::min(maxSubStep_, ADAPTIVE_MAX_SUBSTEP);
+
+    dt_ = std::min(std::max(TIME_STEP, ADAPTIVE_DT_MIN), ADAPTIVE_DT_MAX);
+    subSteps_ = std::min(std::max(SUB_STEP_COUNT, ADAPTIVE_SUBSTEPS_MIN), ADAPTIVE_SUBSTEPS_MAX);
+    stepsSinceOverlapScan_ = ADAPTIVE_OVERLAP_CHECK_EVERY; // medir en el primer paso
+    maxSpeed_ = 0.0f;
+    maxOverlap_ = 0.0f;
+}
+
+// =========================================================
+// MEDICIONES
+// =========================================================
+
+float AdaptiveStepController::measureMaxOverlap(const std::vector<ParticleInfo>& particles) {
+    float maxOverlap = 0.0f;
+    for (const auto& p : particles) {
+        int capacity = b2Body_GetContactCapacity(p.bodyId);
+        if (capacity <= 0) continue;
+        if ((int)contactBuffer_.size() < capacity) contactBuffer_.resize(capacity);
+
+        int count = b2Body_GetContactData(p.bodyId, contactBuffer_.data(), capacity);
+        for (int c = 0; c < count; ++c) {
+            const b2Manifold& m = contactBuffer_[c].manifold;
+            for (int k = 0; k < m.pointCount; ++k) {
+                maxOverlap = std::max(maxOverlap, -m.points[k].separation);
+            }
+        }
+    }
+    return maxOverlap;
+}
+
+// =========================================================
+// ELECCIÓN DEL PASO
+// =========================================================
+
+StepChoice AdaptiveStepController::choose(const std::vector<ParticleInfo>& particles) {
+    // 1) Velocidad máxima (incluye la velocidad de borde por rotación)
+    const StateSnapshot& S = stateSnapshot;
+    stateSnapshot.refreshVelocities(particles);
+    float vmax = 0.0f;
+    for (int i : S.awakeList) {
+        float speed = std::sqrt(S.vx[i]*S.vx[i] + S.vy[i]*S.vy[i]) + std::fabs(S.w[i]) * particles[i].size;
+        vmax = std::max(vmax, speed);
+    }
+    maxSpeed_ = vmax;
+
+    // 2) Superposición máxima (más cara: se mide cada ADAPTIVE_OVERLAP_CHECK_EVERY pasos).
+    // Sólo se reacciona en el paso de la medición: una muestra mala reduce dt una vez, no en
+    // cada paso hasta la próxima medición.
+    bool freshOverlap = false;
+    if (++stepsSinceOverlapScan_ >= ADAPTIVE_OVERLAP_CHECK_EVERY) {
+        maxOverlap_ = measureMaxOverlap(particles);
+        stepsSinceOverlapScan_ = 0;
+        freshOverlap = true;
+    }
+
+    const float allowedDisp  = ADAPTIVE_CFL * minRadius_;
+    const float overlapLimit = ADAPTIVE_MAX_OVERLAP * minRadius_;
+    const bool  overlapping  = freshOverlap && (maxOverlap_ > overlapLimit);
+
+    // 3) dt: crece despacio si todo está en regla, se reduce a la mitad ante superposición.
+    // Aun con el máximo de subpasos, el desplazamiento por subpaso y el subpaso de seguridad
+    // deben respetarse; los límites [ADAPTIVE_DT_MIN, ADAPTIVE_DT_MAX] se aplican al final
+    float dt = overlapping ? 0.5f * dt_ : dt_ * ADAPTIVE_DT_GROWTH;
+    if (vmax > 0.0f) {
+        dt = std::min(dt, allowedDisp * ADAPTIVE_SUBSTEPS_MAX / vmax);
+    }
+    dt = std::min(dt, maxSubStep_ * ADAPTIVE_SUBSTEPS_MAX);
+    dt = std::min(std::max(dt, ADAPTIVE_DT_MIN), ADAPTIVE_DT_MAX);
+
+    // 4) Subpasos: los justos para el desplazamiento y para el subpaso de seguridad; el doble
+    // del actual ante superposición
+    int subSteps = ADAPTIVE_SUBSTEPS_MIN;
+    if (allowedDisp > 0.0f) {
+        subSteps = std::max(subSteps, (int)std::ceil(vmax * dt / allowedDisp));
+    }
+    subSteps = std::max(subSteps, (int)std::ceil(dt / maxSubStep_ - 1e-3f));
+    if (overlapping) {
+        subSteps = std::max(subSteps, 2 * subSteps_);
+    }
+    subSteps = std::min(std::max(subSteps, ADAPTIVE_SUBSTEPS_MIN), ADAPTIVE_SUBSTEPS_MAX);
+
+    dt_ = dt;
+    subSteps_ = subSteps;
+    return {dt_, subSteps_};
+}
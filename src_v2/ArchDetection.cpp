@@ -0,0 +1,173 @@
+// src/ArchDetection.cpp
+
+#include "ArchDetection.h"
+#include "Constants.h"
+#include "Initialization.h"
+#include "StateSnapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+enum : uint8_t { SUPPORT_LEFT = 1, SUPPORT_RIGHT = 2 };
+
+// Buffers reutilizados entre llamadas (uno por hilo de réplica)
+struct ArchScratch {
+    std::vector<int> window;                 // partículas candidatas
+    std::vector<int> slot;                   // partícula -> posición en window (-1 fuera)
+    std::vector<uint8_t> support;            // apoyos en los bordes del orificio, por slot
+    std::vector<std::pair<int, int>> edges;  // contactos entre candidatas (slots)
+    std::vector<int> adjStart, adj;          // grafo en formato CSR
+    std::vector<int> order;                  // slots por altura creciente
+    std::vector<int> set;                    // unión-búsqueda sobre slots
+    std::vector<uint8_t> reach;              // apoyos del conjunto, en su representante
+    std::vector<uint8_t> active;             // slot por debajo de la altura del arco
+    std::vector<int> parent, queue;
+    std::vector<b2ContactData> contacts;
+};
+
+thread_local ArchScratch scratch;
+
+int findSet(std::vector<int>& set, int k) {
+    while (set[k] != k) k = set[k] = set[set[k]];
+    return k;
+}
+
+} // namespace
+
+bool detectArch(ArchInfo& arch) {
+    ArchScratch& s = scratch;
+    const StateSnapshot& S = stateSnapshot;
+    const int n = (int)std::min(particleBodyIds.size(), S.size());
+
+    // Ventana sobre el orificio: los arcos se apoyan cerca de los bordes y no suben mucho más
+    // que su luz
+    const float edgeX   = OUTLET_X_HALF_WIDTH;
+    const float halfX   = OUTLET_X_HALF_WIDTH + OUTLET_WIDTH;
+    const float topY    = GROUND_LEVEL_Y + 3.0f * OUTLET_WIDTH;
+    const float edgeTol = 0.05f * BASE_RADIUS;
+
+    if ((int)s.slot.size() != n) s.slot.assign(n, -1);
+    s.window.clear();
+    for (int i = 0; i < n; ++i) {
+        if (S.y[i] > EXIT_BELOW_Y && S.y[i] < topY && std::fabs(S.x[i]) < halfX) {
+            s.slot[i] = (int)s.window.size();
+            s.window.push_back(i);
+        }
+    }
+    const int m = (int)s.window.size();
+
+    // Contactos con puntos de la ventana: entre partículas y contra el piso en los bordes
+    s.support.assign(m, 0);
+    s.edges.clear();
+    for (int k = 0; k < m; ++k) {
+        const int i = s.window[k];
+        const b2BodyId body = particleBodyIds[i];
+
+        const int capacity = b2Body_GetContactCapacity(body);
+        if ((int)s.contacts.size() < capacity) s.contacts.resize(capacity);
+        const int count = b2Body_GetContactData(body, s.contacts.data(), capacity);
+
+        for (int c = 0; c < count; ++c) {
+            const b2ContactData& cd = s.contacts[c];
+            if (cd.manifold.pointCount <= 0) continue;
+
+            const b2BodyId bodyA = b2Shape_GetBody(cd.shapeIdA);
+            const b2BodyId other = B2_ID_EQUALS(bodyA, body) ? b2Shape_GetBody(cd.shapeIdB) : bodyA;
+
+            const int j = getParticleIndex(other);
+            if (j >= 0) {
+                // Cada contacto aparece en los dos cuerpos: se guarda una vez
+                if (j < n && j > i && s.slot[j] >= 0) s.edges.push_back({k, s.slot[j]});
+            } else if (b2Body_GetType(other) != b2_dynamicBody) {
+                // Apoyo sólo en la arista del orificio: un contacto con el piso más lejos es
+                // una partícula que descansa al costado, no el pie de un arco
+                for (int p = 0; p < cd.manifold.pointCount; ++p) {
+                    const float px = cd.manifold.points[p].point.x;
+                    if (std::fabs(px + edgeX) <= edgeTol) s.support[k] |= SUPPORT_LEFT;
+                    if (std::fabs(px - edgeX) <= edgeTol) s.support[k] |= SUPPORT_RIGHT;
+                }
+            }
+        }
+    }
+
+    for (int i : s.window) s.slot[i] = -1;
+
+    // Grafo no dirigido en CSR
+    s.adjStart.assign(m + 1, 0);
+    for (const auto& e : s.edges) { ++s.adjStart[e.first + 1]; ++s.adjStart[e.second + 1]; }
+    for (int k = 0; k < m; ++k) s.adjStart[k + 1] += s.adjStart[k];
+    s.adj.resize(s.adjStart[m]);
+    s.parent.assign(s.adjStart.begin(), s.adjStart.end() - 1);   // cursor de escritura
+    for (const auto& e : s.edges) {
+        s.adj[s.parent[e.first]++]  = e.second;
+        s.adj[s.parent[e.second]++] = e.first;
+    }
+
+    // Altura del arco más bajo: se agregan las partículas de abajo hacia arriba uniendo las que
+    // están en contacto; la primera que deja un conjunto con apoyo izquierdo y derecho fija la
+    // altura mínima que puede tener una cadena de borde a borde (camino minimax en y)
+    s.order.resize(m);
+    for (int k = 0; k < m; ++k) s.order[k] = k;
+    std::sort(s.order.begin(), s.order.end(),
+              [&](int a, int b) { return S.y[s.window[a]] < S.y[s.window[b]]; });
+    s.set.resize(m);
+    s.reach.assign(m, 0);
+    s.active.assign(m, 0);
+    float archTopY = 0.0f;
+    bool spans = false;
+    for (int k : s.order) {
+        s.set[k] = k;
+        s.reach[k] = s.support[k];
+        s.active[k] = 1;
+        int root = k;
+        for (int e = s.adjStart[k]; e < s.adjStart[k + 1]; ++e) {
+            const int v = s.adj[e];
+            if (!s.active[v]) continue;
+            const int rv = findSet(s.set, v);
+            if (rv == root) continue;
+            s.set[rv] = root;
+            s.reach[root] |= s.reach[rv];
+        }
+        if (s.reach[root] == (SUPPORT_LEFT | SUPPORT_RIGHT)) {
+            archTopY = S.y[s.window[k]];
+            spans = true;
+            break;
+        }
+    }
+    if (!spans) return false;
+
+    // Búsqueda en anchura desde los apoyos izquierdos por debajo de esa altura; el primer apoyo
+    // derecho alcanzado cierra el arco más bajo con la menor cantidad de partículas
+    for (int k = 0; k < m; ++k) s.active[k] = (S.y[s.window[k]] <= archTopY);
+    const int UNSEEN = -2, ROOT = -1;
+    s.parent.assign(m, UNSEEN);
+    s.queue.clear();
+    for (int k = 0; k < m; ++k) {
+        if (s.active[k] && (s.support[k] & SUPPORT_LEFT)) { s.parent[k] = ROOT; s.queue.push_back(k); }
+    }
+
+    int end = -1;
+    for (size_t head = 0; head < s.queue.size() && end < 0; ++head) {
+        const int k = s.queue[head];
+        if (s.support[k] & SUPPORT_RIGHT) { end = k; break; }
+        for (int e = s.adjStart[k]; e < s.adjStart[k + 1]; ++e) {
+            const int v = s.adj[e];
+            if (!s.active[v] || s.parent[v] != UNSEEN) continue;
+            s.parent[v] = k;
+            s.queue.push_back(v);
+        }
+    }
+    if (end < 0) return false;
+
+    arch.particles.clear();
+    for (int k = end; k != ROOT; k = s.parent[k]) arch.particles.push_back(s.window[k]);
+    std::reverse(arch.particles.begin(), arch.particles.end());
+
+    arch.leftX  = S.x[arch.particles.front()];
+    arch.rightX = S.x[arch.particles.back()];
+    arch.peakY  = -1e30f;
+    for (int i : arch.particles) arch.peakY = std::max(arch.peakY, S.y[i]);
+    return true;
+}
@@ -0,0 +1,231 @@
+// src/AsyncWriter.cpp
+
+#include "AsyncWriter.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sys/types.h>
+
+namespace {
+const int SPIN_BEFORE_SLEEP = 256;
+const std::chrono::microseconds PRODUCER_BACKOFF(50);
+const std::chrono::milliseconds WRITER_IDLE_WAIT(5);
+
+// Guarda el primer error del archivo; los siguientes suelen ser consecuencia de ése
+void recordError(std::atomic<int>* error) {
+    int expected = 0;
+    error->compare_exchange_strong(expected, errno != 0 ? errno : EIO, std::memory_order_acq_rel);
+}
+}
+
+// =========================================================
+// HILO ESCRITOR
+// =========================================================
+
+AsyncWriter::AsyncWriter()
+    : thread_(&AsyncWriter::writerLoop, this)
+{
+}
+
+AsyncWriter::~AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    sleepCondition_.notify_all();
+    thread_.join();
+}
+
+void AsyncWriter::writerLoop() {
+    Job job;
+    for (;;) {
+        if (jobs_.pop(job)) {
+            switch (job.op) {
+            case Op::WRITE:
+                errno = 0;
+                if (std::fwrite(job.block->data, 1, job.block->used, job.file) != job.block->used) {
+                    recordError(job.error);
+                }
+                bytesWritten_.fetch_add((long long)job.block->used, std::memory_order_relaxed);
+                job.block->used = 0;
+                freeBlocks_.push(job.block);   // nunca se llena: hay a lo sumo MAX_BLOCKS bloques
+                break;
+            case Op::SEEK:
+                errno = 0;
+                if (std::fflush(job.file) != 0 || fseeko(job.file, (off_t)job.offset, SEEK_SET) != 0) {
+                    recordError(job.error);
+                }
+                break;
+            case Op::CLOSE:
+                errno = 0;
+                if (std::fclose(job.file) != 0) recordError(job.error);
+                job.done->store(true, std::memory_order_release);
+                break;
+            }
+            continue;
+        }
+
+        // Sale sólo con la cola vacía: todo lo encolado antes del destructor llega al disco
+        if (stop_.load(std::memory_order_acquire)) break;
+
+        int spins = 0;
+        while (jobs_.empty() && !stop_.load(std::memory_order_acquire) && spins++ < SPIN_BEFORE_SLEEP) {
+            std::this_thread::yield();
+        }
+        if (jobs_.empty()) {
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            writerSleeping_.store(true);
+            sleepCondition_.wait_for(lock, WRITER_IDLE_WAIT, [this] {
+                return stop_.load() || !jobs_.empty();
+            });
+            writerSleeping_.store(false);
+        }
+    }
+}
+
+// =========================================================
+// LADO PRODUCTOR
+// =========================================================
+
+void AsyncWriter::waitForRoom() {
+    // Contrapresión: el disco va más lento que la simulación
+    stalls_.fetch_add(1, std::memory_order_relaxed);
+    for (int i = 0; i < SPIN_BEFORE_SLEEP; ++i) std::this_thread::yield();
+    std::this_thread::sleep_for(PRODUCER_BACKOFF);
+}
+
+AsyncWriter::Block* AsyncWriter::acquireBlock() {
+    Block* block = nullptr;
+    if (freeBlocks_.pop(block)) return block;
+
+    if ((int)pool_.size() < MAX_BLOCKS) {
+        pool_.push_back(std::make_unique<Block>());
+        return pool_.back().get();
+    }
+
+    while (!freeBlocks_.pop(block)) {
+        waitForRoom();
+    }
+    return block;
+}
+
+void AsyncWriter::submit(const Job& job) {
+    while (!jobs_.push(job)) {
+        waitForRoom();
+    }
+    if (writerSleeping_.load()) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        sleepCondition_.notify_one();
+    }
+}
+
+void AsyncWriter::submitWrite(std::FILE* file, Block* block, std::atomic<int>* error) {
+    submit({Op::WRITE, file, block, 0, nullptr, error});
+}
+
+void AsyncWriter::submitSeek(std::FILE* file, uint64_t offset, std::atomic<int>* error) {
+    submit({Op::SEEK, file, nullptr, offset, nullptr, error});
+}
+
+void AsyncWriter::submitClose(std::FILE* file, std::atomic<bool>* done, std::atomic<int>* error) {
+    submit({Op::CLOSE, file, nullptr, 0, done, error});
+}
+
+AsyncWriter& defaultAsyncWriter() {
+    // Uno por hilo: las colas SPSC exigen un único productor
+    requireConfig("defaultAsyncWriter");
+    static thread_local AsyncWriter writer;
+    return writer;
+}
+
+// =========================================================
+// STREAMBUF ASÍNCRONO
+// =========================================================
+
+bool AsyncStreamBuf::open(const std::string& path, AsyncWriter& writer) {
+    close();
+
+    // La apertura es sincrónica: los errores se informan en el momento
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return false;
+
+    path_ = path;
+    error_.store(0, std::memory_order_release);
+    writer_ = &writer;
+    blockStart_ = 0;
+    block_ = writer_->acquireBlock();
+    setp(block_->data, block_->data + AsyncWriter::BLOCK_BYTES);
+    return true;
+}
+
+void AsyncStreamBuf::handOff() {
+    const size_t used = (size_t)(pptr() - pbase());
+    if (used == 0) return;
+
+    block_->used = used;
+    writer_->submitWrite(file_, block_, &error_);
+    blockStart_ += used;
+
+    block_ = writer_->acquireBlock();
+    setp(block_->data, block_->data + AsyncWriter::BLOCK_BYTES);
+}
+
+AsyncStreamBuf::int_type AsyncStreamBuf::overflow(int_type ch) {
+    if (!file_) return traits_type::eof();
+
+    handOff();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int AsyncStreamBuf::sync() {
+    if (!file_) return -1;
+    handOff();
+    return 0;
+}
+
+AsyncStreamBuf::pos_type AsyncStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                 std::ios_base::openmode which)
+{
+    // Sólo tellp (desplazamiento 0 desde la posición actual); el resto va por seekpos
+    if (!file_ || !(which & std::ios_base::out) || dir != std::ios_base::cur || off != 0) {
+        return pos_type(off_type(-1));
+    }
+    return pos_type(off_type(blockStart_ + (uint64_t)(pptr() - pbase())));
+}
+
+AsyncStreamBuf::pos_type AsyncStreamBuf::seekpos(pos_type pos, std::ios_base::openmode which) {
+    if (!file_ || !(which & std::ios_base::out)) return pos_type(off_type(-1));
+
+    // Lo pendiente se escribe antes de mover el cursor del archivo (las tareas van en orden)
+    handOff();
+    writer_->submitSeek(file_, (uint64_t)off_type(pos), &error_);
+    blockStart_ = (uint64_t)off_type(pos);
+    return pos;
+}
+
+bool AsyncStreamBuf::close() {
+    if (!file_) return error() == 0;
+
+    handOff();
+    // El bloque vacío vuelve al escritor para que lo recicle
+    block_->used = 0;
+    writer_->submitWrite(file_, block_, &error_);
+    block_ = nullptr;
+    setp(nullptr, nullptr);
+
+    std::atomic<bool> done{false};
+    writer_->submitClose(file_, &done, &error_);
+    while (!done.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(PRODUCER_BACKOFF);
+    }
+
+    file_ = nullptr;
+    writer_ = nullptr;
+    return error() == 0;
+}
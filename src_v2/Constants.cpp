@@ -1,12 +1,14 @@
 // src/Constants.cpp
 
 #include "Constants.h"
+#include "RandomStreams.h"
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <filesystem>
 #include <cstring>
 #include <ctime>
+#include <cstdlib>
 
 
 // =================================================================================================
@@ -14,87 +16,242 @@
 // =================================================================================================
 
 // Parámetros ajustables
-float BASE_RADIUS = 0.5f;
-float SIZE_RATIO = 0.0f;
-float CHI = 0.0f;
-int TOTAL_PARTICLES = 2000;
-float OUTLET_WIDTH = 3.9f*2*BASE_RADIUS;
-float SILO_WIDTH = 20.2f*2*BASE_RADIUS;
-float silo_height = 120*2*BASE_RADIUS;
+thread_local float BASE_RADIUS = 0.5f;
+thread_local float SIZE_RATIO = 0.0f;
+thread_local float CHI = 0.0f;
+thread_local int TOTAL_PARTICLES = 2000;
+thread_local float OUTLET_WIDTH = 3.9f*2*BASE_RADIUS;
+thread_local float SILO_WIDTH = 20.2f*2*BASE_RADIUS;
+thread_local float silo_height = 120*2*BASE_RADIUS;
+thread_local int NUM_THREADS = 1;
 
 // Variables de conteo y control
-int MAX_AVALANCHES = 50;
+thread_local int MAX_AVALANCHES = 50;
 
 // Parámetros de reinyección configurables
-float REINJECT_HEIGHT_RATIO = 1.0f;
-float REINJECT_HEIGHT_VARIATION = 0.043f;
-float REINJECT_WIDTH_RATIO = 0.31f;
+thread_local float REINJECT_HEIGHT_RATIO = 1.0f;
+thread_local float REINJECT_HEIGHT_VARIATION = 0.043f;
+thread_local float REINJECT_WIDTH_RATIO = 0.31f;
+thread_local float REINJECT_VELOCITY = 0.0f;
+
+// Paso de tiempo adaptativo en la fase de flujo
+thread_local bool ADAPTIVE_STEPPING = false;
+thread_local float ADAPTIVE_DT_MIN = 0.000125f;     // TIME_STEP / 4
+thread_local float ADAPTIVE_DT_MAX = 0.002f;        // TIME_STEP * 4
+thread_local int ADAPTIVE_SUBSTEPS_MIN = 4;
+thread_local int ADAPTIVE_SUBSTEPS_MAX = 40;        // SUB_STEP_COUNT
+thread_local float ADAPTIVE_CFL = 0.05f;            // desplazamiento máx. por subpaso / radio mínimo
+thread_local float ADAPTIVE_MAX_OVERLAP = 0.05f;    // superposición máx. / radio mínimo
+thread_local float ADAPTIVE_DT_GROWTH = 1.05f;
+thread_local int ADAPTIVE_OVERLAP_CHECK_EVERY = 10;
+thread_local float ADAPTIVE_MAX_SUBSTEP = 0.0f;     // 0 = sólo el subpaso de seguridad
+
+// Detección de salidas con sensores Box2D
+thread_local bool USE_EXIT_SENSORS = false;
+
+// Escritura de archivos en hilo aparte
+thread_local bool ASYNC_OUTPUT = true;
+
+// Códec de frames
+thread_local int FRAME_CODEC = 1;
+thread_local float FRAME_TOLERANCE = 1e-4f;
+thread_local int FRAME_KEYFRAME_EVERY = 100;
+
+// Caché de empaquetamientos sedimentados
+thread_local std::string PACKING_CACHE_DIR = "";
+thread_local long long PACKING_SEED = -1;
+
+// Generador del empaquetamiento inicial (tandas con caída por defecto)
+thread_local int PACKING_GENERATOR = PACKING_GENERATOR_BATCHES;
+
+// Arco del atasco por grafo de contactos (barrido de rayos como alternativa)
+thread_local int ARCH_DETECTION = ARCH_DETECTION_CONTACTS;
+
+// Confirmación de atascos por arco (s sin salidas)
+thread_local float JAM_CONFIRM_TIME = 0.25f;
+
+// Avance rápido de atascos dormidos
+thread_local bool JAM_FAST_FORWARD = true;
+
+// Región de interés (desactivada: se integra todo el silo)
+thread_local float ROI_HEIGHT = 0.0f;
+
+// Integración multi-paso (desactivada)
+thread_local int MULTIRATE_RATIO = 1;
+thread_local float MULTIRATE_ZONE = 6.0f;
+
+// Réplicas de descarga a partir de una única foto sedimentada
+thread_local bool FORK_DISCHARGES = false;
 
 // =================================================================================================
 // 2. VARIABLES DE ESTADO Y DATOS
 // =================================================================================================
 
 // Parámetros de partículas
-int NUM_LARGE_CIRCLES = 0;
-int NUM_SMALL_CIRCLES = 0;
-int NUM_POLYGON_PARTICLES = 0;
-int NUM_SIDES = 5;
-float POLYGON_PERIMETER = 0.0f;
+thread_local int NUM_LARGE_CIRCLES = 0;
+thread_local int NUM_SMALL_CIRCLES = 0;
+thread_local int NUM_POLYGON_PARTICLES = 0;
+thread_local int NUM_SIDES = 5;
+thread_local float POLYGON_PERIMETER = 0.0f;
 
 // Variables derivadas
-float OUTLET_X_HALF_WIDTH = 0.0f;
+thread_local float OUTLET_X_HALF_WIDTH = 0.0f;
+
+// Control de réplicas y guardado
+thread_local bool SAVE_SIMULATION_DATA = false;
+thread_local int TOTAL_SIMULATIONS = 1;
+thread_local int PARALLEL_REPLICAS = 1;
+thread_local long long RANDOM_SEED = -1;
+
+// Barrido de parámetros
+thread_local std::string SWEEP_SOURCE = "";
+thread_local std::string QUEUE_DIR = "";
+thread_local float LEASE_TTL = 600.0f;
+
+// Frecuencias de pasos (definidas en main.cpp)
+extern thread_local int EXIT_CHECK_EVERY_STEPS;
+extern thread_local int SAVE_FRAME_EVERY_STEPS;
+
+// Sólo los hilos que recibieron la configuración (ver requireConfig)
+thread_local bool configApplied = false;
+
+void markConfigApplied() {
+    configApplied = true;
+}
 
+void requireConfig(const char* where) {
+#ifndef NDEBUG
+    if (!configApplied) {
+        std::cerr << "Error interno: " << where << " en un hilo sin configuración "
+                     "(falta applyConfig); leería los valores por defecto\n";
+        std::abort();
+    }
+#else
+    (void)where;
+#endif
+}
+
+SimulationConfig captureConfig() {
+    requireConfig("captureConfig");
+    SimulationConfig config;
+#define CAPTURE_FIELD(type, name) config.name = name;
+    SIMULATION_CONFIG_FIELDS(CAPTURE_FIELD)
+#undef CAPTURE_FIELD
+    return config;
+}
+
+void applyConfig(const SimulationConfig& config) {
+#define APPLY_FIELD(type, name) name = config.name;
+    SIMULATION_CONFIG_FIELDS(APPLY_FIELD)
+#undef APPLY_FIELD
+    configApplied = true;
+}
+
+
+// =================================================================================================
+// 3. ESTADO POR RÉPLICA (thread_local)
+// =================================================================================================
 
 // Variables de estado y registro
-float simulationTime = 0.0f;
-float lastPrintTime = 0.0f;
-float lastRaycastTime = -0.5f;
-float lastShockTime = 0.0f;
-int frameCounter = 0;
-bool SAVE_SIMULATION_DATA = false;
-int CURRENT_SIMULATION = 1;
-int TOTAL_SIMULATIONS = 1;
+thread_local float simulationTime = 0.0f;
+thread_local float lastPrintTime = 0.0f;
+thread_local float lastRaycastTime = -0.5f;
+thread_local float lastShockTime = 0.0f;
+thread_local float lastArchCheckTime = 0.0f;
+thread_local int frameCounter = 0;
+thread_local int CURRENT_SIMULATION = 1;
 
 // Archivos de salida
-std::ofstream simulationDataFile;
-std::ofstream avalancheDataFile;
-std::ofstream flowDataFile;
+thread_local std::ofstream simulationDataFile;
+thread_local std::ofstream avalancheDataFile;
+thread_local std::ofstream flowDataFile;
+thread_local std::ofstream adaptiveStepFile;
+thread_local std::ofstream archDataFile;
 
 // Variables de flujo
-int avalancheCount = 0;
-float totalFlowingTime = 0.0f;
-float totalBlockageTime = 0.0f;
-bool inAvalanche = false;
-bool inBlockage = false;
-float blockageStartTime = 0.0f;
-float avalancheStartTime = 0.0f;
-int particlesInCurrentAvalanche = 0;
-int avalancheStartParticleCount = 0;
-float lastExitDuringAvalanche = 0.0f;
-float lastParticleExitTime = 0.0f;
-float previousBlockageDuration = 0.0f;
-int blockageRetryCount = 0;
+thread_local int avalancheCount = 0;
+thread_local float totalFlowingTime = 0.0f;
+thread_local float totalBlockageTime = 0.0f;
+thread_local bool inAvalanche = false;
+thread_local bool inBlockage = false;
+thread_local float blockageStartTime = 0.0f;
+thread_local float jamBreakDelay = 2.0f;
+thread_local float avalancheStartTime = 0.0f;
+thread_local int particlesInCurrentAvalanche = 0;
+thread_local int avalancheStartParticleCount = 0;
+thread_local float lastExitDuringAvalanche = 0.0f;
+thread_local float lastParticleExitTime = 0.0f;
+thread_local float previousBlockageDuration = 0.0f;
+thread_local int blockageRetryCount = 0;
 
 // Variables de registro de flujo
-float totalExitedMass = 0.0f;
-int totalExitedParticles = 0;
-float totalExitedOriginalMass = 0.0f;
-int totalExitedOriginalParticles = 0;
-float lastRecordedTime = -0.01f;
-float accumulatedMass = 0.0f;
-int accumulatedParticles = 0;
-float accumulatedOriginalMass = 0.0f;
-int accumulatedOriginalParticles = 0;
+thread_local float totalExitedMass = 0.0f;
+thread_local int totalExitedParticles = 0;
+thread_local float totalExitedOriginalMass = 0.0f;
+thread_local int totalExitedOriginalParticles = 0;
+thread_local float lastRecordedTime = -0.01f;
+thread_local float accumulatedMass = 0.0f;
+thread_local int accumulatedParticles = 0;
+thread_local float accumulatedOriginalMass = 0.0f;
+thread_local int accumulatedOriginalParticles = 0;
 
 // Variables para seguimiento de progreso real del flujo
-int lastTotalExitedCount = 0;
-float lastProgressTime = 0.0f;
-bool waitingForFlowConfirmation = false;
-
-// RNG Engine y distribuciones
-std::mt19937 randomEngine(time(NULL));
-std::uniform_real_distribution<> angleDistribution(0.0f, 2.0f * M_PI);
-std::uniform_real_distribution<> impulseMagnitudeDistribution(0.0f, 1.0f);
+thread_local int lastTotalExitedCount = 0;
+thread_local float lastProgressTime = 0.0f;
+thread_local bool waitingForFlowConfirmation = false;
 
 // Set para rastrear partículas que ya salieron en la avalancha actual
-std::set<b2BodyId, BodyIdComparator> particlesExitedInCurrentAvalanche;
\ No newline at end of file
+thread_local std::set<b2BodyId, BodyIdComparator> particlesExitedInCurrentAvalanche;
+
+// =================================================================================================
+// 4. REINICIO DEL ESTADO POR RÉPLICA
+// =================================================================================================
+
+void resetRunState(int simulationIndex, uint64_t seed) {
+    simulationTime = 0.0f;
+    lastPrintTime = 0.0f;
+    lastRaycastTime = -0.5f;
+    lastShockTime = 0.0f;
+    lastArchCheckTime = 0.0f;
+    frameCounter = 0;
+    CURRENT_SIMULATION = simulationIndex;
+
+    if (simulationDataFile.is_open()) simulationDataFile.close();
+    if (avalancheDataFile.is_open()) avalancheDataFile.close();
+    if (flowDataFile.is_open()) flowDataFile.close();
+    if (adaptiveStepFile.is_open()) adaptiveStepFile.close();
+    if (archDataFile.is_open()) archDataFile.close();
+
+    avalancheCount = 0;
+    totalFlowingTime = 0.0f;
+    totalBlockageTime = 0.0f;
+    inAvalanche = false;
+    inBlockage = false;
+    blockageStartTime = 0.0f;
+    jamBreakDelay = 2.0f;
+    avalancheStartTime = 0.0f;
+    particlesInCurrentAvalanche = 0;
+    avalancheStartParticleCount = 0;
+    lastExitDuringAvalanche = 0.0f;
+    lastParticleExitTime = 0.0f;
+    previousBlockageDuration = 0.0f;
+    blockageRetryCount = 0;
+
+    totalExitedMass = 0.0f;
+    totalExitedParticles = 0;
+    totalExitedOriginalMass = 0.0f;
+    totalExitedOriginalParticles = 0;
+    lastRecordedTime = -0.01f;
+    accumulatedMass = 0.0f;
+    accumulatedParticles = 0;
+    accumulatedOriginalMass = 0.0f;
+    accumulatedOriginalParticles = 0;
+
+    lastTotalExitedCount = 0;
+    lastProgressTime = 0.0f;
+    waitingForFlowConfirmation = false;
+
+    seedReplicaStreams(seed, (uint32_t)simulationIndex);
+
+    particlesExitedInCurrentAvalanche.clear();
+}
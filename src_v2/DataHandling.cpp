@@ -3,6 +3,12 @@
 #include "DataHandling.h"
 #include "Constants.h"
 #include "Initialization.h"
+#include "StateSnapshot.h"
+#include "FrameFormat.h"
+#include "AsyncWriter.h"
+#include "RandomStreams.h"
+#include "ArchDetection.h"
+#include "ReinjectionSlots.h"
 #include <iostream>
 #include <vector>
 #include <cmath>
@@ -39,9 +45,47 @@ float RaycastCallback(b2ShapeId shapeId, b2Vec2 point, b2Vec2 normal, float frac
 // IMPLEMENTACIÓN DE FUNCIONES DE INICIALIZACIÓN/FINALIZACIÓN DE DATOS
 // =========================================================
 
-void initializeDataFiles() {
+// Frames de partículas en formato binario (FrameFormat.h); se abre con el primer frame,
+// cuando ya existen las partículas y se conocen sus atributos estáticos
+static thread_local std::string outputDirectory;
+static thread_local std::string stagingDirectory;
+static thread_local frames::FrameWriter frameWriter;
+static thread_local std::vector<float> angleBuffer;
+
+// Salida asíncrona (--async-output 1): un buffer por archivo, todos servidos por el escritor del hilo
+static thread_local AsyncStreamBuf frameBuf, avalancheBuf, flowBuf, adaptiveBuf, archBuf;
+
+// Los ofstream globales (compartidos con src/) se redirigen al buffer asíncrono con rdbuf;
+// el filebuf propio del ofstream queda sin abrir
+static void openOutput(std::ofstream& stream, AsyncStreamBuf& buf, const std::string& path) {
+    if (ASYNC_OUTPUT && buf.open(path, defaultAsyncWriter())) {
+        static_cast<std::ostream&>(stream).rdbuf(&buf);
+        stream.clear();
+    } else {
+        stream.open(path);
+    }
+}
+
+// Los errores de la salida asíncrona ocurren en el hilo escritor; se informan al cerrar
+static void closeAsync(AsyncStreamBuf& buf) {
+    if (!buf.close()) {
+        std::cerr << "Error: falló la escritura de " << buf.path() << ": "
+                  << std::strerror(buf.error()) << "\n";
+    }
+}
 
-    // Crear directorio de resultados
+static void closeOutput(std::ofstream& stream, AsyncStreamBuf& buf) {
+    if (buf.isOpen()) {
+        stream.flush();
+        closeAsync(buf);   // espera a que el escritor vuelque todo
+        static_cast<std::ostream&>(stream).rdbuf(stream.rdbuf());
+        stream.clear();
+    } else if (stream.is_open()) {
+        stream.close();
+    }
+}
+
+std::string replicaOutputDirectory() {
     std::ostringstream dirNameStream;
     dirNameStream << "sim_" << CURRENT_SIMULATION
                   << "part_" << TOTAL_PARTICLES
@@ -55,27 +99,36 @@ void initializeDataFiles() {
                   << "_outlet" << std::setprecision(2) << OUTLET_WIDTH
                   << "_maxAva" << MAX_AVALANCHES;
 
-    std::string outputDir = "./simulations/" + dirNameStream.str() + "/";
+    return "./simulations/" + dirNameStream.str() + "/";
+}
+
+void setReplicaStagingDirectory(const std::string& dir) {
+    stagingDirectory = dir;
+}
+
+void initializeDataFiles() {
+
+    // Crear directorio de resultados (o el de preparación, si la réplica se publica después)
+    std::string outputDir = stagingDirectory.empty() ? replicaOutputDirectory() : stagingDirectory;
     std::filesystem::create_directories(outputDir);
 
-    // Abrir archivos de salida
-    if (SAVE_SIMULATION_DATA) {
-        simulationDataFile.open(outputDir + "simulation_data.csv");
-        simulationDataFile << "Time";
-        for (int i = 0; i < TOTAL_PARTICLES; ++i) {
-            simulationDataFile << ",p" << i << "_x,p" << i << "_y,p" << i << "_type,p" << i << "_size,p" << i << "_sides,p" << i << "_angle";
-        }
-        simulationDataFile << ",rays_begin";
-        for (int i = 0; i < 120; ++i) {
-            simulationDataFile << ",ray" << i << "_x1,ray" << i << "_y1,ray" << i << "_x2,ray" << i << "_y2";
-        }
-        simulationDataFile << ",rays_end\n";
-    }
-    avalancheDataFile.open(outputDir + "avalanche_data.csv");
-    flowDataFile.open(outputDir + "flow_data.csv");
+    // Abrir archivos de salida (simulation_data.bin se abre en el primer recordFrame)
+    outputDirectory = outputDir;
+    openOutput(avalancheDataFile, avalancheBuf, outputDir + "avalanche_data.csv");
+    openOutput(flowDataFile, flowBuf, outputDir + "flow_data.csv");
 
     // Encabezado para flow_data.csv
     flowDataFile << "Time,MassTotal,MassFlowRate,NoPTotal,NoPFlowRate,MassOriginalTotal,MassOriginalFlowRate,NoPOriginalTotal,NoPOriginalFlowRate\n";
+
+    // Arcos desarmados en los atascos (partículas en orden del apoyo izquierdo al derecho)
+    openOutput(archDataFile, archBuf, outputDir + "arch_data.csv");
+    archDataFile << "Time,Retry,Particles,LeftX,RightX,PeakY,Indices\n";
+
+    // Registro del paso adaptativo (dt y subpasos elegidos)
+    if (ADAPTIVE_STEPPING) {
+        openOutput(adaptiveStepFile, adaptiveBuf, outputDir + "adaptive_dt.csv");
+        adaptiveStepFile << "Time,dt,SubSteps,MaxSpeed,MaxOverlap\n";
+    }
 }
 
 void finalizeDataFiles(bool simulationInterrupted) {
@@ -102,9 +155,18 @@ void finalizeDataFiles(bool simulationInterrupted) {
     avalancheDataFile << "# Máximo de avalanchas alcanzado: " << (avalancheCount >= MAX_AVALANCHES ? "Sí" : "No") << "\n";
 
 
-    if (SAVE_SIMULATION_DATA) simulationDataFile.close();
-    avalancheDataFile.close();
-    flowDataFile.close();
+    // Con salida asíncrona, cada cierre espera a que el hilo escritor termine de volcar
+    frameWriter.close();
+    if (frameBuf.isOpen()) closeAsync(frameBuf);
+    closeOutput(avalancheDataFile, avalancheBuf);
+    closeOutput(flowDataFile, flowBuf);
+    closeOutput(adaptiveStepFile, adaptiveBuf);
+    closeOutput(archDataFile, archBuf);
+
+    if (ASYNC_OUTPUT && defaultAsyncWriter().stallCount() > 0) {
+        std::cout << "Salida asíncrona: " << defaultAsyncWriter().stallCount()
+                  << " esperas por disco lento\n";
+    }
 
     std::cout << "\n===== SIMULACIÓN COMPLETADA =====\n";
     std::cout << "Avalanchas registradas: " << avalancheCount << "/" << MAX_AVALANCHES << "\n";
@@ -112,74 +174,148 @@ void finalizeDataFiles(bool simulationInterrupted) {
     std::cout << "Partículas salientes: " << totalExitedParticles << "\n";
 }
 
+void recordFrame(uint64_t step, float currentTime) {
+    if (!frameWriter.isOpen()) {
+        frames::StaticColumns columns;
+        columns.type.reserve(particles.size());
+        columns.sides.reserve(particles.size());
+        columns.size.reserve(particles.size());
+        for (const auto& p : particles) {
+            columns.type.push_back((uint8_t)p.shapeType);
+            columns.sides.push_back((uint8_t)p.numSides);
+            columns.size.push_back(p.size);
+        }
+        frames::CodecConfig codec;
+        codec.codec = (FRAME_CODEC == 1) ? frames::CODEC_DELTA_Q : frames::CODEC_RAW_F32;
+        codec.tolerance = FRAME_TOLERANCE;
+        codec.keyframeInterval = (uint32_t)FRAME_KEYFRAME_EVERY;
+
+        const std::string path = outputDirectory + "simulation_data.bin";
+        const bool opened = (ASYNC_OUTPUT && frameBuf.open(path, defaultAsyncWriter()))
+                                ? frameWriter.open(&frameBuf, columns, BASE_RADIUS, codec)
+                                : frameWriter.open(path, columns, BASE_RADIUS, codec);
+        if (!opened) {
+            std::cerr << "Error: no se pudo crear " << outputDirectory << "simulation_data.bin\n";
+            return;
+        }
+    }
+
+    const StateSnapshot& S = stateSnapshot;
+    angleBuffer.resize(S.size());
+    for (size_t i = 0; i < S.size(); ++i) angleBuffer[i] = S.angle(i);
+    frameWriter.writeFrame(step, currentTime, S.x.data(), S.y.data(), angleBuffer.data());
+}
+
 // =========================================================
 // IMPLEMENTACIÓN DE FUNCIONES DE FÍSICA Y FLUJO
 // =========================================================
 
 void applyRandomImpulses() {
     if (simulationTime - lastShockTime >= SHOCK_INTERVAL) {
-        for (const auto& particle : particles) {
-            float magnitude = impulseMagnitudeDistribution(randomEngine) * 0.5f;
-            float angle = angleDistribution(randomEngine);
-            b2Vec2 impulse = { magnitude * cos(angle), magnitude * sin(angle) };
-            b2Body_ApplyLinearImpulseToCenter(particle.bodyId, impulse, true);
+        // Magnitud y ángulo de todas las partículas en una sola tanda del flujo de impulsos
+        static thread_local std::vector<float> shock;
+        shock.resize(2 * particles.size());
+        rng(RNG_SHOCKS).uniforms(shock.data(), shock.size());
+        for (size_t i = 0; i < particles.size(); ++i) {
+            float magnitude = shock[2 * i] * 0.5f;
+            float angle = shock[2 * i + 1] * 2.0f * (float)M_PI;
+            b2Vec2 impulse = { magnitude * std::cos(angle), magnitude * std::sin(angle) };
+            b2Body_ApplyLinearImpulseToCenter(particles[i].bodyId, impulse, true);
         }
         lastShockTime = simulationTime;
     }
 }
 
+// Contabiliza la salida de la partícula i por el orificio
+static void countExit(size_t i, float currentTime,
+                      int& exitedTotalCount, float& exitedTotalMass,
+                      int& exitedOriginalCount, float& exitedOriginalMass)
+{
+    exitedTotalCount++;
+    exitedTotalMass += particles[i].mass;
+    lastParticleExitTime = currentTime;
+
+    if (particles[i].isOriginal) {
+        exitedOriginalCount++;
+        exitedOriginalMass += particles[i].mass;
+    }
+}
+
 void manageParticles(b2WorldId worldId, float currentTime, float siloHeight,
                      int& exitedTotalCount, float& exitedTotalMass,
                      int& exitedOriginalCount, float& exitedOriginalMass)
 {
-    const float EXIT_BELOW_Y = -1.5f;
     const float OUTLET_LEFT_X  = -OUTLET_X_HALF_WIDTH;
     const float OUTLET_RIGHT_X =  OUTLET_X_HALF_WIDTH;
 
-    const float REINJECT_HALF_WIDTH = SILO_WIDTH * REINJECT_WIDTH_RATIO * 0.5f;
-    const float REINJECT_MIN_X = -REINJECT_HALF_WIDTH;
-    const float REINJECT_MAX_X =  REINJECT_HALF_WIDTH;
-    const float REINJECT_MIN_Y = siloHeight * REINJECT_HEIGHT_RATIO;
-    const float REINJECT_MAX_Y = siloHeight * (REINJECT_HEIGHT_RATIO + REINJECT_HEIGHT_VARIATION);
-
     exitedTotalCount = 0;
     exitedTotalMass = 0.0f;
     exitedOriginalCount = 0;
     exitedOriginalMass = 0.0f;
 
-    for (size_t i = 0; i < particleBodyIds.size(); ++i) {
-        b2BodyId particleId = particleBodyIds[i];
-        b2Vec2 pos = b2Body_GetPosition(particleId);
+    // Posiciones de la foto del último paso (stepWorld); se reinyectan todas juntas al final
+    static thread_local std::vector<int> recycled;
+    recycled.clear();
+
+    const StateSnapshot& S = stateSnapshot;
+    for (size_t i = 0; i < particleBodyIds.size() && i < S.size(); ++i) {
+        const b2Vec2 pos = {S.x[i], S.y[i]};
 
         if (pos.y < EXIT_BELOW_Y && pos.x >= OUTLET_LEFT_X && pos.x <= OUTLET_RIGHT_X) {
-            exitedTotalCount++;
-            exitedTotalMass += particles[i].mass;
-            lastParticleExitTime = currentTime;
+            countExit(i, currentTime, exitedTotalCount, exitedTotalMass,
+                      exitedOriginalCount, exitedOriginalMass);
+            recycled.push_back((int)i);
+        }
 
-            if (particles[i].isOriginal) {
-                exitedOriginalCount++;
-                exitedOriginalMass += particles[i].mass;
-            }
+        else if (pos.y < EXIT_BELOW_Y || pos.x < -SILO_WIDTH || pos.x > SILO_WIDTH) {
+            recycled.push_back((int)i);
+        }
+    }
+    reinjectionSlots.place(recycled, siloHeight);
+}
 
-            float randomX = REINJECT_MIN_X + (REINJECT_MAX_X - REINJECT_MIN_X) * static_cast<float>(rand()) / RAND_MAX;
-            float randomY = REINJECT_MIN_Y + (REINJECT_MAX_Y - REINJECT_MIN_Y) * static_cast<float>(rand()) / RAND_MAX;
+void manageParticlesFromSensors(b2WorldId worldId, float currentTime, float siloHeight,
+                                int& exitedTotalCount, float& exitedTotalMass,
+                                int& exitedOriginalCount, float& exitedOriginalMass)
+{
+    exitedTotalCount = 0;
+    exitedTotalMass = 0.0f;
+    exitedOriginalCount = 0;
+    exitedOriginalMass = 0.0f;
 
-            b2Body_SetTransform(particleId, (b2Vec2){randomX, randomY}, (b2Rot){0.0f, 1.0f});
-            b2Body_SetLinearVelocity(particleId, (b2Vec2){0.0f, 0.0f});
-            b2Body_SetAngularVelocity(particleId, 0.0f);
-            b2Body_SetAwake(particleId, true);
-        }
+    // Paso en que se atendió cada partícula: una misma partícula puede tocar el sensor del
+    // orificio y un catch-all en el mismo paso; sólo se procesa una vez (el orificio primero).
+    static thread_local std::vector<int> handledAtFrame;
+    if (handledAtFrame.size() != particles.size()) {
+        handledAtFrame.assign(particles.size(), -1);
+    }
 
-        else if (pos.y < EXIT_BELOW_Y || pos.x < -SILO_WIDTH || pos.x > SILO_WIDTH) {
-            float randomX = REINJECT_MIN_X + (REINJECT_MAX_X - REINJECT_MIN_X) * static_cast<float>(rand()) / RAND_MAX;
-            float randomY = REINJECT_MIN_Y + (REINJECT_MAX_Y - REINJECT_MIN_Y) * static_cast<float>(rand()) / RAND_MAX;
+    static thread_local std::vector<int> recycled;
+    recycled.clear();
 
-            b2Body_SetTransform(particleId, (b2Vec2){randomX, randomY}, (b2Rot){0.0f, 1.0f});
-            b2Body_SetLinearVelocity(particleId, (b2Vec2){0.0f, 0.0f});
-            b2Body_SetAngularVelocity(particleId, 0.0f);
-            b2Body_SetAwake(particleId, true);
+    b2SensorEvents events = b2World_GetSensorEvents(worldId);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool outletPass = (pass == 0);
+        for (int e = 0; e < events.beginCount; ++e) {
+            const b2SensorBeginTouchEvent& ev = events.beginEvents[e];
+            const bool isOutlet = B2_ID_EQUALS(ev.sensorShapeId, outletSensorShapeId);
+            if (isOutlet != outletPass) continue;
+            if (!b2Shape_IsValid(ev.visitorShapeId)) continue;
+
+            b2BodyId bodyId = b2Shape_GetBody(ev.visitorShapeId);
+            int i = getParticleIndex(bodyId);
+            if (i < 0 || i >= (int)particles.size() || handledAtFrame[i] == frameCounter) continue;
+            handledAtFrame[i] = frameCounter;
+
+            if (isOutlet) {
+                countExit(i, currentTime, exitedTotalCount, exitedTotalMass,
+                          exitedOriginalCount, exitedOriginalMass);
+            }
+            recycled.push_back(i);
         }
     }
+    reinjectionSlots.place(recycled, siloHeight);
 }
 
 void recordFlowData(float currentTime, int exitedTotalCount, float exitedTotalMass,
@@ -217,6 +353,20 @@ void recordFlowData(float currentTime, int exitedTotalCount, float exitedTotalMa
     }
 }
 
+// Sube una partícula del arco a la altura de reinyección conservando su x (con jitter)
+static void liftArchParticle(b2BodyId body, float reinjectHeight) {
+    b2Vec2 pos = b2Body_GetPosition(body);
+    float jitter = rng(RNG_REINJECTION).uniform(-0.025f, 0.025f);
+    b2Vec2 newPos = { pos.x + jitter, reinjectHeight + (rng(RNG_REINJECTION).uniform() - 0.5f) * REINJECT_HEIGHT_VARIATION };
+
+    b2Rot rotation = b2Body_GetRotation(body);
+    b2Body_SetTransform(body, newPos, rotation);
+    stateSnapshot.setPose(getParticleIndex(body), newPos, rotation);
+    b2Body_SetLinearVelocity(body, {0.0f, 0.0f});
+    b2Body_SetAngularVelocity(body, 0.0f);
+    b2Body_SetAwake(body, true);
+}
+
 void detectAndReinjectArchViaRaycast(b2WorldId worldId, float siloHeight) {
 
     const float REINJECT_HEIGHT = siloHeight * REINJECT_HEIGHT_RATIO;
@@ -268,16 +418,7 @@ void detectAndReinjectArchViaRaycast(b2WorldId worldId, float siloHeight) {
 
     for (b2BodyId body : raycastData.hitBodies) {
         if (reinjected >= maxReinjectPerStep) break;
-
-        b2Vec2 pos = b2Body_GetPosition(body);
-        float jitter = ((float)rand() / RAND_MAX - 0.5f) * 0.05f;
-        b2Vec2 newPos = { pos.x + jitter, REINJECT_HEIGHT + ((float)rand() / RAND_MAX - 0.5f) * REINJECT_HEIGHT_VARIATION };
-
-        b2Body_SetTransform(body, newPos, b2Body_GetRotation(body));
-        b2Body_SetLinearVelocity(body, {0.0f, 0.0f});
-        b2Body_SetAngularVelocity(body, 0.0f);
-        b2Body_SetAwake(body, true);
-
+        liftArchParticle(body, REINJECT_HEIGHT);
         ++reinjected;
     }
 
@@ -287,9 +428,37 @@ void detectAndReinjectArchViaRaycast(b2WorldId worldId, float siloHeight) {
               << std::min(baseRange * progressiveMultiplier * localMultiplier, maxRange) << " m)\n";
 }
 
-void finalizeAvalanche() {
+void breakArch(b2WorldId worldId, float siloHeight) {
+    static thread_local ArchInfo arch;
 
-    float currentAvalancheDuration = simulationTime - avalancheStartTime;
+    if (ARCH_DETECTION != ARCH_DETECTION_CONTACTS || !detectArch(arch)) {
+        detectAndReinjectArchViaRaycast(worldId, siloHeight);
+        return;
+    }
+
+    archDataFile << std::fixed << std::setprecision(5) << simulationTime << ","
+                 << blockageRetryCount << "," << arch.particles.size() << ","
+                 << arch.leftX << "," << arch.rightX << "," << arch.peakY << ",";
+    for (size_t k = 0; k < arch.particles.size(); ++k) {
+        archDataFile << (k ? " " : "") << arch.particles[k];
+    }
+    archDataFile << "\n";
+
+    // Se sube sólo el arco: el material que sostenía cae y reanuda el flujo
+    const float REINJECT_HEIGHT = siloHeight * REINJECT_HEIGHT_RATIO;
+    for (int i : arch.particles) {
+        liftArchParticle(particleBodyIds[i], REINJECT_HEIGHT);
+    }
+
+    std::cout << "Arco de " << arch.particles.size() << " partículas reinyectado "
+              << "(Intento global #" << blockageRetryCount << ", luz "
+              << std::fixed << std::setprecision(2) << (arch.rightX - arch.leftX)
+              << " m, altura " << arch.peakY << " m)\n";
+}
+
+void finalizeAvalancheAt(float endTime) {
+
+    float currentAvalancheDuration = endTime - avalancheStartTime;
 
     if (currentAvalancheDuration >= MIN_AVALANCHE_DURATION) {
         totalFlowingTime += currentAvalancheDuration;
@@ -297,7 +466,7 @@ void finalizeAvalanche() {
 
         avalancheDataFile << "Avalancha " << (avalancheCount + 1) << ","
                         << avalancheStartTime << ","
-                        << simulationTime << ","
+                        << endTime << ","
                         << currentAvalancheDuration << ","
                         << particlesInThisAvalanche << "\n";
 
@@ -311,6 +480,10 @@ void finalizeAvalanche() {
     inAvalanche = false;
 }
 
+void finalizeAvalanche() {
+    finalizeAvalancheAt(simulationTime);
+}
+
 void startAvalanche() {
     inAvalanche = true;
     avalancheStartTime = simulationTime;
@@ -319,12 +492,59 @@ void startAvalanche() {
     std::cout << "Inicio de avalancha " << (avalancheCount + 1) << " a t=" << simulationTime << "s\n";
 }
 
+// Como siempre, la avalancha termina y el atasco empieza en el instante de la detección
 void startBlockage() {
     finalizeAvalanche();
     inBlockage = true;
     blockageStartTime = simulationTime;
+    jamBreakDelay = 2.0f;
     blockageRetryCount = 0;
-    std::cout << "Atasco detectado a t=" << simulationTime << "s\n";
+    std::cout << "Atasco detectado a t=" << simulationTime << "s (última salida t="
+              << lastParticleExitTime << "s)\n";
+}
+
+// Atasco confirmado por el estado de contactos: sin salidas durante JAM_CONFIRM_TIME y un arco
+// que cruza el orificio con todas sus partículas casi quietas. Se revisa a lo sumo cuatro
+// veces por JAM_CONFIRM_TIME.
+static bool archJamConfirmed(float timeSinceLastExit) {
+    if (JAM_CONFIRM_TIME <= 0.0f || timeSinceLastExit < JAM_CONFIRM_TIME) return false;
+    if (simulationTime - lastArchCheckTime < 0.25f * JAM_CONFIRM_TIME) return false;
+    lastArchCheckTime = simulationTime;
+
+    static thread_local ArchInfo arch;
+    if (!detectArch(arch)) return false;
+
+    const StateSnapshot& S = stateSnapshot;
+    stateSnapshot.refreshVelocities(particles);
+    const float vMax2 = JAM_ARCH_MAX_SPEED * JAM_ARCH_MAX_SPEED;
+    for (int i : arch.particles) {
+        if (S.vx[i]*S.vx[i] + S.vy[i]*S.vy[i] > vMax2) return false;
+    }
+    return true;
+}
+
+// El primer desarme espera jamBreakDelay desde la detección para que el atasco pueda
+// resolverse solo: 2 s tras el umbral de 5 s, JAM_CONFIRM_TIME tras un arco confirmado
+float nextJamBreakTime() {
+    const float firstAttempt = blockageStartTime + jamBreakDelay;
+    return std::max(std::nextafter(firstAttempt, 1e30f), lastRaycastTime + RAYCAST_COOLDOWN);
+}
+
+bool fastForwardJam() {
+    if (!inBlockage) return false;
+
+    const float target = nextJamBreakTime();
+    if (target <= simulationTime) return false;
+
+    // Filas de flujo nulo para el intervalo salteado (mismo muestreo que recordFlowData)
+    for (;;) {
+        float t = lastRecordedTime + RECORD_INTERVAL;
+        while (t - lastRecordedTime < RECORD_INTERVAL) t = std::nextafter(t, 1e30f);   // redondeo
+        if (t > target) break;
+        recordFlowData(t, 0, 0.0f, 0, 0.0f);
+    }
+    simulationTime = target;
+    return true;
 }
 
 void checkFlowStatus(b2WorldId worldId, float timeSinceLastExit) {
@@ -336,8 +556,13 @@ void checkFlowStatus(b2WorldId worldId, float timeSinceLastExit) {
         }
     }
     else if (inAvalanche) {
-        // Durante avalancha: verificar si se atasca
-        if (timeSinceLastExit > BLOCKAGE_THRESHOLD) {
+        // Durante avalancha: verificar si se atasca. Un arco quieto confirma el atasco antes
+        // del umbral de 5 s; la espera hasta el primer desarme se escala con la confirmación.
+        if (archJamConfirmed(timeSinceLastExit)) {
+            startBlockage();
+            jamBreakDelay = JAM_CONFIRM_TIME;
+        }
+        else if (timeSinceLastExit > BLOCKAGE_THRESHOLD) {
             startBlockage();
         }
     }
@@ -351,12 +576,10 @@ void checkFlowStatus(b2WorldId worldId, float timeSinceLastExit) {
             startAvalanche();
             std::cout << "Flujo reanudado después de atasco de " << blockageDuration << "s\n";
         }
-        else if (simulationTime - blockageStartTime > 2.0f) {
-            if (simulationTime - lastRaycastTime >= RAYCAST_COOLDOWN) {
-                detectAndReinjectArchViaRaycast(worldId, silo_height);
-                lastRaycastTime = simulationTime;
-                blockageRetryCount++;
-            }
+        else if (simulationTime >= nextJamBreakTime()) {
+            breakArch(worldId, silo_height);
+            lastRaycastTime = simulationTime;
+            blockageRetryCount++;
         }
     }
 
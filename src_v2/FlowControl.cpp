@@ -1,4 +1,5 @@
 #include "FlowControl.h"
+#include "RandomStreams.h"
 #include <algorithm>
 #include <iomanip>
 
@@ -55,14 +56,12 @@ void detectAndReinjectArchViaRaycast(b2WorldId worldId) {
     const int maxReinjectPerStep = 10;
     int reinjected = 0;
 
-    std::uniform_real_distribution<> jitterDistribution(-0.05f, 0.05f);
-
     for (b2BodyId body : raycastData.hitBodies) {
         if (reinjected >= maxReinjectPerStep) break;
 
         b2Vec2 pos = b2Body_GetPosition(body);
-        float jitter = jitterDistribution(randomEngine);
-        float randomY = REINJECT_HEIGHT + ((float)rand() / RAND_MAX - 0.5f) * REINJECT_HEIGHT_VARIATION;
+        float jitter = rng(RNG_REINJECTION).uniform(-0.05f, 0.05f);
+        float randomY = REINJECT_HEIGHT + (rng(RNG_REINJECTION).uniform() - 0.5f) * REINJECT_HEIGHT_VARIATION;
         b2Vec2 newPos = { pos.x + jitter, randomY };
 
         b2Body_SetTransform(body, newPos, b2Body_GetRotation(body));
@@ -0,0 +1,217 @@
+// src/FrameFormat.cpp
+
+#include "FrameFormat.h"
+#include <algorithm>
+#include <cstring>
+
+namespace frames {
+
+namespace {
+const size_t FILE_BUFFER_BYTES = 1 << 20;
+
+uint32_t rawPayloadBytes(uint32_t particleCount) {
+    return 3u * particleCount * (uint32_t)sizeof(float);
+}
+}
+
+// =========================================================
+// ESCRITURA
+// =========================================================
+
+bool FrameWriter::open(const std::string& path, const StaticColumns& columns, float baseRadius,
+                       const CodecConfig& codec)
+{
+    close();
+    if (!ownFile_.open(path, std::ios::out | std::ios::binary | std::ios::trunc)) return false;
+    return open(&ownFile_, columns, baseRadius, codec);
+}
+
+bool FrameWriter::open(std::streambuf* out, const StaticColumns& columns, float baseRadius,
+                       const CodecConfig& codec)
+{
+    if (out != &ownFile_) close();
+    if (!out) return false;
+
+    out_ = out;
+    position_ = 0;
+    header_ = FrameFileHeader{};
+    std::memcpy(header_.magic, MAGIC, sizeof(MAGIC));
+    header_.version       = VERSION;
+    header_.particleCount = (uint32_t)columns.type.size();
+    header_.codec         = codec.codec;
+    header_.baseRadius    = baseRadius;
+    index_.clear();
+
+    if (header_.codec == CODEC_DELTA_Q) {
+        header_.posQuantum       = codec.tolerance * baseRadius;
+        header_.angleQuantum     = codec.tolerance;
+        header_.keyframeInterval = std::max(1u, codec.keyframeInterval);
+        encoder_.configure(header_.particleCount, header_.posQuantum, header_.angleQuantum);
+    }
+
+    const size_t n = header_.particleCount;
+    put(&header_, sizeof(header_));
+    put(columns.type.data(),  n * sizeof(uint8_t));
+    put(columns.sides.data(), n * sizeof(uint8_t));
+    put(columns.size.data(),  n * sizeof(float));
+    return true;
+}
+
+void FrameWriter::put(const void* data, size_t bytes) {
+    out_->sputn(static_cast<const char*>(data), (std::streamsize)bytes);
+    position_ += bytes;
+}
+
+void FrameWriter::writeFrame(uint64_t step, double time,
+                             const float* x, const float* y, const float* angle)
+{
+    if (!out_) return;
+
+    const size_t n = header_.particleCount;
+    FrameRecordHeader record{};
+    record.step = step;
+    record.time = time;
+
+    if (header_.codec == CODEC_DELTA_Q) {
+        const bool keyframe = (index_.size() % header_.keyframeInterval == 0);
+        encoder_.encode(x, y, angle, keyframe, payload_);
+        record.payloadBytes = (uint32_t)payload_.size();
+        record.flags = keyframe ? FRAME_FLAG_KEYFRAME : 0u;
+        index_.push_back({step, time, position_});
+        put(&record, sizeof(record));
+        put(payload_.data(), payload_.size());
+        return;
+    }
+
+    record.payloadBytes = rawPayloadBytes(header_.particleCount);
+    record.flags = FRAME_FLAG_KEYFRAME;
+    index_.push_back({step, time, position_});
+    put(&record, sizeof(record));
+    put(x,     n * sizeof(float));
+    put(y,     n * sizeof(float));
+    put(angle, n * sizeof(float));
+}
+
+void FrameWriter::close() {
+    if (!out_) return;
+
+    header_.frameCount  = index_.size();
+    header_.indexOffset = position_;
+    if (!index_.empty()) {
+        put(index_.data(), index_.size() * sizeof(FrameIndexEntry));
+    }
+
+    out_->pubseekpos(0, std::ios::out);
+    out_->sputn(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    out_->pubsync();
+    if (ownFile_.is_open()) ownFile_.close();
+    out_ = nullptr;
+    index_.clear();
+}
+
+// =========================================================
+// LECTURA SECUENCIAL
+// =========================================================
+
+bool FrameReader::open(const std::string& path) {
+    close();
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) return false;
+    std::setvbuf(file_, nullptr, _IOFBF, FILE_BUFFER_BYTES);
+
+    if (std::fread(&header_, sizeof(header_), 1, file_) != 1 ||
+        std::memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header_.version != VERSION ||
+        (header_.codec != CODEC_RAW_F32 && header_.codec != CODEC_DELTA_Q)) {
+        close();
+        return false;
+    }
+
+    const size_t n = header_.particleCount;
+    columns_.type.resize(n);
+    columns_.sides.resize(n);
+    columns_.size.resize(n);
+    if (std::fread(columns_.type.data(),  sizeof(uint8_t), n, file_) != n ||
+        std::fread(columns_.sides.data(), sizeof(uint8_t), n, file_) != n ||
+        std::fread(columns_.size.data(),  sizeof(float),   n, file_) != n) {
+        close();
+        return false;
+    }
+
+    if (header_.codec == CODEC_DELTA_Q) {
+        decoder_.configure(n, header_.posQuantum, header_.angleQuantum);
+    }
+
+    // Sin índice (corrida cortada): los frames llegan hasta el final del archivo
+    dataEnd_ = header_.indexOffset;
+    if (dataEnd_ == 0) {
+        long here = std::ftell(file_);
+        std::fseek(file_, 0, SEEK_END);
+        dataEnd_ = (uint64_t)std::ftell(file_);
+        std::fseek(file_, here, SEEK_SET);
+    }
+    return true;
+}
+
+void FrameReader::close() {
+    if (file_) std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool FrameReader::next(Frame& frame) {
+    if (!file_) return false;
+    if ((uint64_t)std::ftell(file_) + sizeof(FrameRecordHeader) > dataEnd_) return false;
+
+    FrameRecordHeader record;
+    if (std::fread(&record, sizeof(record), 1, file_) != 1) return false;
+
+    const size_t n = header_.particleCount;
+    frame.step = record.step;
+    frame.time = record.time;
+    frame.x.resize(n);
+    frame.y.resize(n);
+    frame.angle.resize(n);
+
+    if (header_.codec == CODEC_DELTA_Q) {
+        payload_.resize(record.payloadBytes);
+        if (std::fread(payload_.data(), 1, payload_.size(), file_) != payload_.size()) return false;
+        return decoder_.decode(payload_.data(), payload_.size(),
+                               (record.flags & FRAME_FLAG_KEYFRAME) != 0,
+                               frame.x.data(), frame.y.data(), frame.angle.data());
+    }
+
+    if (record.payloadBytes != rawPayloadBytes(header_.particleCount)) return false;
+    return std::fread(frame.x.data(),     sizeof(float), n, file_) == n &&
+           std::fread(frame.y.data(),     sizeof(float), n, file_) == n &&
+           std::fread(frame.angle.data(), sizeof(float), n, file_) == n;
+}
+
+// =========================================================
+// COMPATIBILIDAD CON EL CSV
+// =========================================================
+
+void writeCsvHeader(std::FILE* out, uint32_t particleCount) {
+    std::fputs("Time", out);
+    for (uint32_t i = 0; i < particleCount; ++i) {
+        std::fprintf(out, ",p%u_x,p%u_y,p%u_type,p%u_size,p%u_sides,p%u_angle", i, i, i, i, i, i);
+    }
+    std::fputs(",rays_begin", out);
+    for (int i = 0; i < 120; ++i) {
+        std::fprintf(out, ",ray%d_x1,ray%d_y1,ray%d_x2,ray%d_y2", i, i, i, i);
+    }
+    std::fputs(",rays_end\n", out);
+}
+
+void writeCsvRow(std::FILE* out, const StaticColumns& columns, const Frame& frame) {
+    // Mismo formato que el volcado de texto original (std::fixed, 5 decimales)
+    std::fprintf(out, "%.5f", frame.time);
+    for (size_t i = 0; i < frame.x.size(); ++i) {
+        std::fprintf(out, ",%.5f,%.5f,%d,%.5f,%d,%.5f",
+                     frame.x[i], frame.y[i], (int)columns.type[i], columns.size[i],
+                     (int)columns.sides[i], frame.angle[i]);
+    }
+    std::fputc('\n', out);
+}
+
+} // namespace frames
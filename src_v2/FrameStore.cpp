@@ -0,0 +1,173 @@
+// src/FrameStore.cpp
+
+#include "FrameStore.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace frames {
+
+// =========================================================
+// APERTURA / CIERRE
+// =========================================================
+
+bool FrameStore::open(const std::string& path) {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || (size_t)st.st_size < sizeof(FrameFileHeader)) {
+        close();
+        return false;
+    }
+    size_ = (size_t)st.st_size;
+
+    void* map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        base_ = nullptr;
+        close();
+        return false;
+    }
+    base_ = static_cast<const uint8_t*>(map);
+
+    std::memcpy(&header_, base_, sizeof(header_));
+    if (std::memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0 || header_.version != VERSION ||
+        (header_.codec != CODEC_RAW_F32 && header_.codec != CODEC_DELTA_Q)) {
+        close();
+        return false;
+    }
+
+    // Atributos estáticos
+    const size_t n = header_.particleCount;
+    const size_t staticBytes = n * (2 * sizeof(uint8_t) + sizeof(float));
+    size_t offset = sizeof(FrameFileHeader);
+    if (offset + staticBytes > size_) {
+        close();
+        return false;
+    }
+    columns_.type.assign(base_ + offset, base_ + offset + n);
+    columns_.sides.assign(base_ + offset + n, base_ + offset + 2 * n);
+    columns_.size.resize(n);
+    std::memcpy(columns_.size.data(), base_ + offset + 2 * n, n * sizeof(float));
+    offset += staticBytes;
+
+    // Índice: el del archivo o, si la corrida se cortó, uno armado recorriendo los registros
+    index_.clear();
+    const uint64_t indexBytes = header_.frameCount * sizeof(FrameIndexEntry);
+    if (header_.indexOffset != 0 && header_.indexOffset + indexBytes <= size_) {
+        index_.resize(header_.frameCount);
+        std::memcpy(index_.data(), base_ + header_.indexOffset, indexBytes);
+    } else {
+        while (offset + sizeof(FrameRecordHeader) <= size_) {
+            FrameRecordHeader record;
+            std::memcpy(&record, base_ + offset, sizeof(record));
+            if (offset + sizeof(record) + record.payloadBytes > size_) break;   // registro truncado
+            index_.push_back({record.step, record.time, (uint64_t)offset});
+            offset += sizeof(record) + record.payloadBytes;
+        }
+    }
+
+    if (header_.codec == CODEC_DELTA_Q) {
+        decoder_.configure(n, header_.posQuantum, header_.angleQuantum);
+    }
+    lastDecoded_ = -1;
+    return true;
+}
+
+void FrameStore::close() {
+    if (base_) ::munmap(const_cast<uint8_t*>(base_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    base_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+    index_.clear();
+    lastDecoded_ = -1;
+}
+
+// =========================================================
+// ACCESO A FRAMES
+// =========================================================
+
+bool FrameStore::recordAt(size_t k, FrameRecordHeader& record, const uint8_t*& payload) const {
+    const uint64_t offset = index_[k].offset;
+    if (offset + sizeof(FrameRecordHeader) > size_) return false;
+    std::memcpy(&record, base_ + offset, sizeof(record));
+    if (offset + sizeof(record) + record.payloadBytes > size_) return false;
+    payload = base_ + offset + sizeof(record);
+    return true;
+}
+
+bool FrameStore::decodeRecord(size_t k, Frame& out) {
+    FrameRecordHeader record;
+    const uint8_t* payload;
+    if (!recordAt(k, record, payload)) return false;
+
+    const size_t n = header_.particleCount;
+    out.step = record.step;
+    out.time = record.time;
+    out.x.resize(n);
+    out.y.resize(n);
+    out.angle.resize(n);
+
+    if (header_.codec == CODEC_RAW_F32) {
+        if (record.payloadBytes != 3 * n * sizeof(float)) return false;
+        std::memcpy(out.x.data(),     payload,                         n * sizeof(float));
+        std::memcpy(out.y.data(),     payload + n * sizeof(float),     n * sizeof(float));
+        std::memcpy(out.angle.data(), payload + 2 * n * sizeof(float), n * sizeof(float));
+        return true;
+    }
+
+    const bool ok = decoder_.decode(payload, record.payloadBytes,
+                                    (record.flags & FRAME_FLAG_KEYFRAME) != 0,
+                                    out.x.data(), out.y.data(), out.angle.data());
+    lastDecoded_ = ok ? (long long)k : -1;
+    return ok;
+}
+
+bool FrameStore::read(size_t k, Frame& out) {
+    if (!base_ || k >= index_.size()) return false;
+    if (header_.codec == CODEC_RAW_F32) return decodeRecord(k, out);
+
+    // DELTA: se retrocede hasta un keyframe o hasta el frame siguiente al último decodificado
+    // (en ese caso se sigue desde el estado del decodificador)
+    size_t start = k;
+    for (;;) {
+        if (lastDecoded_ >= 0 && (size_t)lastDecoded_ + 1 == start) break;
+        FrameRecordHeader record;
+        const uint8_t* payload;
+        if (!recordAt(start, record, payload)) return false;
+        if ((record.flags & FRAME_FLAG_KEYFRAME) || start == 0) break;
+        --start;
+    }
+
+    for (size_t j = start; j <= k; ++j) {
+        if (!decodeRecord(j, out)) return false;
+    }
+    return true;
+}
+
+// =========================================================
+// SELECCIÓN POR TIEMPO
+// =========================================================
+
+size_t FrameStore::lowerBound(double minTime) const {
+    auto it = std::lower_bound(index_.begin(), index_.end(), minTime,
+                               [](const FrameIndexEntry& e, double t) { return e.time < t; });
+    return (size_t)(it - index_.begin());
+}
+
+std::vector<size_t> FrameStore::select(double minTime, double maxTime, size_t frameStep) const {
+    std::vector<size_t> frames;
+    if (frameStep == 0) frameStep = 1;
+    for (size_t k = lowerBound(minTime); k < index_.size() && index_[k].time <= maxTime; k += frameStep) {
+        frames.push_back(k);
+    }
+    return frames;
+}
+
+} // namespace frames
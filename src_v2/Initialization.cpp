@@ -1,6 +1,11 @@
 // src/Initialization.cpp
 #include "Initialization.h"
 #include "Constants.h"
+#include "TaskScheduler.h"
+#include "StateSnapshot.h"
+#include "RandomStreams.h"
+#include "PlacementGrid.h"
+#include "StabilityMonitor.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,14 +15,14 @@
 
 
 
-#include <unordered_map>
 #include <random>
 #include <cmath>
+#include <mutex>
 
 
 // Frecuencias configurables definidas en main.cpp
-extern int EXIT_CHECK_EVERY_STEPS;
-extern int SAVE_FRAME_EVERY_STEPS;
+extern thread_local int EXIT_CHECK_EVERY_STEPS;
+extern thread_local int SAVE_FRAME_EVERY_STEPS;
 
 static void printUsage() {
     std::cout << "Uso: silo_simulator [opciones]\n";
@@ -32,12 +37,50 @@ static void printUsage() {
     std::cout << "  --num-sides <N>            Lados de los polígonos\n";
     std::cout << "  --current-sim <i>          Índice de simulación actual\n";
     std::cout << "  --total-sims <N>           Cantidad total de simulaciones\n";
-    std::cout << "  --save-sim-data <0|1>      Guardar simulation_data.csv\n";
+    std::cout << "  --save-sim-data <0|1>      Guardar frames (simulation_data.bin)\n";
     std::cout << "  --silo-height <val>        Altura del silo\n";
     std::cout << "  --silo-width <val>         Ancho del silo\n";
     std::cout << "  --outlet-width <val>       Abertura del silo\n";
+    std::cout << "  --max-avalanches <N>       Avalanchas registradas por réplica (default 50)\n";
     std::cout << "  --exit-check-every <N>     Verifica salida de partículas cada N pasos (default 10)\n";
     std::cout << "  --save-frame-every <M>     Guarda frames cada M pasos (default 100)\n";
+    std::cout << "  --threads <N>              Hilos para b2World_Step (default 1)\n";
+    std::cout << "  --parallel-replicas <K>    Réplicas (--total-sims) simultáneas en hilos (default 1)\n";
+    std::cout << "  --seed <n>                 Semilla de los flujos aleatorios (default: reloj)\n";
+    std::cout << "  --adaptive-dt <0|1>        Paso de tiempo/subpasos adaptativos en la fase de flujo\n";
+    std::cout << "  --dt-min <val>             dt mínimo adaptativo (default 0.000125)\n";
+    std::cout << "  --dt-max <val>             dt máximo adaptativo (default 0.002)\n";
+    std::cout << "  --substeps-min <N>         Subpasos mínimos adaptativos (default 4)\n";
+    std::cout << "  --substeps-max <N>         Subpasos máximos adaptativos (default 40)\n";
+    std::cout << "  --max-substep <val>        Tope extra del subpaso dt/subpasos (default 0 = sólo seguridad)\n";
+    std::cout << "  --dt-cfl <val>             Desplazamiento máx. por subpaso / radio mínimo (default 0.05)\n";
+    std::cout << "  --dt-max-overlap <val>     Superposición máx. / radio mínimo (default 0.05)\n";
+    std::cout << "  --exit-sensors <0|1>       Detecta salidas con sensores Box2D (cada paso, O(salidas))\n";
+    std::cout << "  --async-output <0|1>       Escribe los archivos en un hilo aparte (default 1)\n";
+    std::cout << "  --frame-codec <raw|delta>  Códec de simulation_data.bin (default delta)\n";
+    std::cout << "  --frame-tolerance <val>    Cuantización de frames / radio base (default 1e-4)\n";
+    std::cout << "  --keyframe-every <N>       Frames entre keyframes del códec delta (default 100)\n";
+    std::cout << "  --packing-cache <dir>      Reutiliza empaquetamientos sedimentados guardados en dir\n";
+    std::cout << "  --packing-seed <n>         Semilla del empaquetamiento (default: índice de réplica)\n";
+    std::cout << "  --fork-discharges <0|1>    Sedimenta una vez y todas las réplicas descargan esa foto\n";
+    std::cout << "  --packing-generator <batches|deposition>  Empaquetamiento inicial: tandas que caen\n";
+    std::cout << "                             (default) o depósito balístico casi en reposo\n";
+    std::cout << "  --arch-detection <contacts|raycast>  Arco a desarmar en un atasco: grafo de\n";
+    std::cout << "                             contactos sobre el orificio (default) o barrido de rayos\n";
+    std::cout << "  --jam-confirm-time <s>     Declara el atasco tras s sin salidas si hay un arco quieto\n";
+    std::cout << "                             sobre el orificio (default 0.25; 0 = sólo umbral de 5 s)\n";
+    std::cout << "  --jam-fast-forward <0|1>   Atasco con todo dormido: salta al próximo desarme (default 1)\n";
+    std::cout << "  --roi-height <H>           Congela las partículas a más de H aberturas sobre el orificio\n";
+    std::cout << "                             y las libera por capas al vaciarse (default 0 = desactivado)\n";
+    std::cout << "  --reinject-velocity <v>    Velocidad inicial hacia abajo de las reinyectadas (default 0)\n";
+    std::cout << "  --multirate <k>            Retiene el volumen lejano k-1 de cada k pasos; aproximación,\n";
+    std::cout << "                             validar contra k = 1 (default 1 = no)\n";
+    std::cout << "  --multirate-zone <H>       Alto de la zona de paso fino, en aberturas (default 6)\n";
+    std::cout << "  --sweep <dir|manifiesto>   Corre todos los archivos KEY=VALUE (los .txt de dir o los\n";
+    std::cout << "                             listados en el manifiesto) en un pool de hilos\n";
+    std::cout << "  --queue-dir <dir>          Con --sweep: reparte las tareas entre procesos/nodos con\n";
+    std::cout << "                             reservas en dir (sistema de archivos compartido)\n";
+    std::cout << "  --lease-ttl <s>            Reserva sin renovar que se da por vencida (default 600)\n";
 }
 
 bool parseAndValidateArgs(int argc, char** argv) {
@@ -94,6 +137,9 @@ bool parseAndValidateArgs(int argc, char** argv) {
         else if (arg == "--outlet-width" && i + 1 < argc) {
             OUTLET_WIDTH = std::stof(argv[++i]);
         }
+        else if (arg == "--max-avalanches" && i + 1 < argc) {
+            MAX_AVALANCHES = std::max(1, std::stoi(argv[++i]));
+        }
         // === NUEVOS FLAGS ===
         else if (arg == "--exit-check-every" && i + 1 < argc) {
             EXIT_CHECK_EVERY_STEPS = std::max(1, std::stoi(argv[++i]));
@@ -101,6 +147,130 @@ bool parseAndValidateArgs(int argc, char** argv) {
         else if (arg == "--save-frame-every" && i + 1 < argc) {
             SAVE_FRAME_EVERY_STEPS = std::max(1, std::stoi(argv[++i]));
         }
+        else if (arg == "--threads" && i + 1 < argc) {
+            NUM_THREADS = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--parallel-replicas" && i + 1 < argc) {
+            PARALLEL_REPLICAS = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--adaptive-dt" && i + 1 < argc) {
+            ADAPTIVE_STEPPING = (std::stoi(argv[++i]) != 0);
+        }
+        else if (arg == "--dt-min" && i + 1 < argc) {
+            ADAPTIVE_DT_MIN = std::stof(argv[++i]);
+        }
+        else if (arg == "--dt-max" && i + 1 < argc) {
+            ADAPTIVE_DT_MAX = std::stof(argv[++i]);
+        }
+        else if (arg == "--substeps-min" && i + 1 < argc) {
+            ADAPTIVE_SUBSTEPS_MIN = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--substeps-max" && i + 1 < argc) {
+            ADAPTIVE_SUBSTEPS_MAX = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--max-substep" && i + 1 < argc) {
+            ADAPTIVE_MAX_SUBSTEP = std::stof(argv[++i]);
+        }
+        else if (arg == "--dt-cfl" && i + 1 < argc) {
+            ADAPTIVE_CFL = std::stof(argv[++i]);
+        }
+        else if (arg == "--dt-max-overlap" && i + 1 < argc) {
+            ADAPTIVE_MAX_OVERLAP = std::stof(argv[++i]);
+        }
+        else if (arg == "--exit-sensors" && i + 1 < argc) {
+            USE_EXIT_SENSORS = (std::stoi(argv[++i]) != 0);
+        }
+        else if (arg == "--async-output" && i + 1 < argc) {
+            ASYNC_OUTPUT = (std::stoi(argv[++i]) != 0);
+        }
+        else if (arg == "--frame-codec" && i + 1 < argc) {
+            std::string codec = argv[++i];
+            if (codec == "raw") FRAME_CODEC = 0;
+            else if (codec == "delta") FRAME_CODEC = 1;
+            else {
+                std::cerr << "Error: --frame-codec debe ser raw o delta.\n";
+                return false;
+            }
+        }
+        else if (arg == "--frame-tolerance" && i + 1 < argc) {
+            FRAME_TOLERANCE = std::stof(argv[++i]);
+        }
+        else if (arg == "--keyframe-every" && i + 1 < argc) {
+            FRAME_KEYFRAME_EVERY = std::stoi(argv[++i]);
+        }
+        else if (arg == "--packing-cache" && i + 1 < argc) {
+            PACKING_CACHE_DIR = argv[++i];
+        }
+        else if (arg == "--packing-seed" && i + 1 < argc) {
+            PACKING_SEED = std::stoll(argv[++i]);
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            RANDOM_SEED = std::stoll(argv[++i]);
+            if (RANDOM_SEED < 0) {
+                std::cerr << "Error: --seed debe ser >= 0.\n";
+                return false;
+            }
+        }
+        else if (arg == "--packing-generator" && i + 1 < argc) {
+            std::string generator = argv[++i];
+            if (generator == "batches") PACKING_GENERATOR = PACKING_GENERATOR_BATCHES;
+            else if (generator == "deposition") PACKING_GENERATOR = PACKING_GENERATOR_DEPOSITION;
+            else {
+                std::cerr << "Error: --packing-generator debe ser batches o deposition.\n";
+                return false;
+            }
+        }
+        else if (arg == "--arch-detection" && i + 1 < argc) {
+            std::string detection = argv[++i];
+            if (detection == "contacts") ARCH_DETECTION = ARCH_DETECTION_CONTACTS;
+            else if (detection == "raycast") ARCH_DETECTION = ARCH_DETECTION_RAYCAST;
+            else {
+                std::cerr << "Error: --arch-detection debe ser contacts o raycast.\n";
+                return false;
+            }
+        }
+        else if (arg == "--jam-confirm-time" && i + 1 < argc) {
+            JAM_CONFIRM_TIME = std::stof(argv[++i]);
+            if (JAM_CONFIRM_TIME < 0.0f) {
+                std::cerr << "Error: --jam-confirm-time debe ser >= 0.\n";
+                return false;
+            }
+        }
+        else if (arg == "--jam-fast-forward" && i + 1 < argc) {
+            JAM_FAST_FORWARD = (std::stoi(argv[++i]) != 0);
+        }
+        else if (arg == "--roi-height" && i + 1 < argc) {
+            ROI_HEIGHT = std::stof(argv[++i]);
+            if (ROI_HEIGHT < 0.0f) {
+                std::cerr << "Error: --roi-height debe ser >= 0.\n";
+                return false;
+            }
+        }
+        else if (arg == "--reinject-velocity" && i + 1 < argc) {
+            REINJECT_VELOCITY = std::stof(argv[++i]);
+        }
+        else if (arg == "--multirate" && i + 1 < argc) {
+            MULTIRATE_RATIO = std::stoi(argv[++i]);
+        }
+        else if (arg == "--multirate-zone" && i + 1 < argc) {
+            MULTIRATE_ZONE = std::stof(argv[++i]);
+        }
+        else if (arg == "--fork-discharges" && i + 1 < argc) {
+            FORK_DISCHARGES = (std::stoi(argv[++i]) != 0);
+        }
+        else if (arg == "--sweep" && i + 1 < argc) {
+            SWEEP_SOURCE = argv[++i];
+        }
+        else if (arg == "--queue-dir" && i + 1 < argc) {
+            QUEUE_DIR = argv[++i];
+        }
+        else if (arg == "--lease-ttl" && i + 1 < argc) {
+            LEASE_TTL = std::stof(argv[++i]);
+            if (LEASE_TTL <= 0.0f) {
+                std::cerr << "Error: --lease-ttl debe ser > 0.\n";
+                return false;
+            }
+        }
         else {
             std::cerr << "Argumento desconocido: " << arg << "\n";
             printUsage();
@@ -108,6 +278,36 @@ bool parseAndValidateArgs(int argc, char** argv) {
         }
     }
 
+    if (ADAPTIVE_DT_MIN <= 0.0f || ADAPTIVE_DT_MAX < ADAPTIVE_DT_MIN ||
+        ADAPTIVE_SUBSTEPS_MAX < ADAPTIVE_SUBSTEPS_MIN ||
+        ADAPTIVE_CFL <= 0.0f || ADAPTIVE_MAX_OVERLAP <= 0.0f || ADAPTIVE_MAX_SUBSTEP < 0.0f ||
+        (ADAPTIVE_MAX_SUBSTEP > 0.0f && ADAPTIVE_DT_MIN > ADAPTIVE_MAX_SUBSTEP * ADAPTIVE_SUBSTEPS_MAX)) {
+        std::cerr << "Error: límites del paso adaptativo inválidos (dt-min <= dt-max, "
+                     "substeps-min <= substeps-max, cfl y overlap > 0, max-substep >= 0, "
+                     "dt-min <= max-substep * substeps-max).\n";
+        return false;
+    }
+
+    if (MULTIRATE_RATIO < 1 || MULTIRATE_ZONE <= 0.0f) {
+        std::cerr << "Error: --multirate debe ser >= 1 y --multirate-zone > 0.\n";
+        return false;
+    }
+    if (MULTIRATE_RATIO > 1 && ROI_HEIGHT > 0.0f) {
+        // Ambos cambian el tipo de los mismos cuerpos
+        std::cerr << "Error: --multirate y --roi-height no se pueden combinar.\n";
+        return false;
+    }
+
+    if (!QUEUE_DIR.empty() && SWEEP_SOURCE.empty()) {
+        std::cerr << "Error: --queue-dir requiere --sweep.\n";
+        return false;
+    }
+
+    if (FRAME_TOLERANCE <= 0.0f || FRAME_KEYFRAME_EVERY < 1) {
+        std::cerr << "Error: --frame-tolerance debe ser > 0 y --keyframe-every >= 1.\n";
+        return false;
+    }
+
     return true;
 }
 
@@ -200,15 +400,31 @@ bool calculateDerivedParameters() {
         SAVE_SIMULATION_DATA = false;
     }
 
+    markConfigApplied();   // el hilo principal ya tiene su configuración
     return true;
 }
 
+// b2CreateWorld/b2DestroyWorld recorren el registro global de mundos de Box2D sin
+// sincronización: con réplicas en paralelo se serializan con este mutex.
+static std::mutex worldRegistryMutex;
+
+void destroyWorld(b2WorldId worldId) {
+    std::lock_guard<std::mutex> lock(worldRegistryMutex);
+    b2DestroyWorld(worldId);
+}
+
 b2WorldId createWorldAndWalls(b2BodyId& outletBlockIdRef) {
 
     // Configurar mundo Box2D
     b2WorldDef worldDef = b2DefaultWorldDef();
     worldDef.gravity = (b2Vec2){0.0f, -9.81f};
-    b2WorldId newWorldId = b2CreateWorld(&worldDef);
+    // Paso multihilo (--threads N): callbacks de tareas del planificador con robo de trabajo
+    defaultTaskScheduler().configureWorldDef(worldDef);
+    b2WorldId newWorldId;
+    {
+        std::lock_guard<std::mutex> lock(worldRegistryMutex);
+        newWorldId = b2CreateWorld(&worldDef);
+    }
 
     worldId = newWorldId;
 
@@ -264,9 +480,58 @@ b2WorldId createWorldAndWalls(b2BodyId& outletBlockIdRef) {
 
     outletBlockIdRef = tempOutletBlockId;
 
+    if (USE_EXIT_SENSORS) {
+        createExitSensors(worldId);
+    }
+
     return newWorldId;
 }
 
+thread_local b2ShapeId outletSensorShapeId = b2_nullShapeId;
+
+void createExitSensors(b2WorldId worldId) {
+    // Sensores estáticos: uno bajo el orificio (salidas que cuentan) y un "catch-all" en U
+    // fuera del silo (escapes que sólo se reinyectan). Mismo criterio que manageParticles:
+    // y < EXIT_BELOW_Y dentro/fuera de la abertura, o |x| > SILO_WIDTH.
+    // La profundidad generosa evita que una partícula rápida atraviese el sensor en un paso.
+    const float depth  = std::max(silo_height, 10.0f);
+    const float topY   = GROUND_LEVEL_Y + silo_height * (REINJECT_HEIGHT_RATIO + REINJECT_HEIGHT_VARIATION) + depth;
+    const float outerX = SILO_WIDTH + depth;
+    const b2Rot noRot  = {1.0f, 0.0f};
+
+    b2BodyDef sensorBodyDef = b2DefaultBodyDef();
+    sensorBodyDef.type = b2_staticBody;
+    b2BodyId sensorBodyId = b2CreateBody(worldId, &sensorBodyDef);
+
+    b2ShapeDef sensorDef = b2DefaultShapeDef();
+    sensorDef.isSensor = true;
+    sensorDef.enableSensorEvents = true;
+
+    // Orificio: franja |x| <= OUTLET_X_HALF_WIDTH por debajo de EXIT_BELOW_Y
+    b2Polygon outletBox = b2MakeOffsetBox(OUTLET_X_HALF_WIDTH, depth / 2.0f,
+                                          (b2Vec2){0.0f, EXIT_BELOW_Y - depth / 2.0f}, noRot);
+    outletSensorShapeId = b2CreatePolygonShape(sensorBodyId, &sensorDef, &outletBox);
+
+    // Catch-all: fondo a ambos lados del orificio
+    const float bottomHalfW = (outerX - OUTLET_X_HALF_WIDTH) / 2.0f;
+    const float bottomCx    = (outerX + OUTLET_X_HALF_WIDTH) / 2.0f;
+    b2Polygon bottomLeft  = b2MakeOffsetBox(bottomHalfW, depth / 2.0f,
+                                            (b2Vec2){-bottomCx, EXIT_BELOW_Y - depth / 2.0f}, noRot);
+    b2Polygon bottomRight = b2MakeOffsetBox(bottomHalfW, depth / 2.0f,
+                                            (b2Vec2){ bottomCx, EXIT_BELOW_Y - depth / 2.0f}, noRot);
+    b2CreatePolygonShape(sensorBodyId, &sensorDef, &bottomLeft);
+    b2CreatePolygonShape(sensorBodyId, &sensorDef, &bottomRight);
+
+    // Catch-all: columnas laterales |x| > SILO_WIDTH
+    const float sideHalfH = (topY - EXIT_BELOW_Y) / 2.0f;
+    const float sideCy    = (topY + EXIT_BELOW_Y) / 2.0f;
+    const float sideCx    = SILO_WIDTH + depth / 2.0f;
+    b2Polygon sideLeft  = b2MakeOffsetBox(depth / 2.0f, sideHalfH, (b2Vec2){-sideCx, sideCy}, noRot);
+    b2Polygon sideRight = b2MakeOffsetBox(depth / 2.0f, sideHalfH, (b2Vec2){ sideCx, sideCy}, noRot);
+    b2CreatePolygonShape(sensorBodyId, &sensorDef, &sideLeft);
+    b2CreatePolygonShape(sensorBodyId, &sensorDef, &sideRight);
+}
+
 
 static void settleUntilStable(b2WorldId worldId,
                               float maxTime = 1.5f,
@@ -276,23 +541,24 @@ static void settleUntilStable(b2WorldId worldId,
                               float stabilityThreshold = 0.1f,
                               int requiredChecks = 2)
 {
+    StabilityCriteria criteria;
+    criteria.kePerParticle = 1e30f;          // sólo |ΔE| entre chequeos
+    criteria.slowFraction  = 0.0f;
+    criteria.keDelta       = stabilityThreshold;
+    StabilityMonitor monitor(criteria);
+
     float t = 0.0f, lastCheck = 0.0f;
-    float prevKE = 1e9f;
     int ok = 0;
 
     while (t < maxTime && ok < requiredChecks) {
-        b2World_Step(worldId, dt, subSteps);
+        stepWorld(worldId, dt, subSteps);
         t += dt;
 
+        // Todos dormidos: no hay nada más que relajar
+        if (particlesQuiescent()) break;
+
         if (t - lastCheck >= checkInterval) {
-            float KE = 0.0f;
-            for (const auto& p : particles) {
-                b2Vec2 v = b2Body_GetLinearVelocity(p.bodyId);
-                KE += 0.5f * p.mass * (v.x*v.x + v.y*v.y);
-            }
-            float dE = std::fabs(KE - prevKE);
-            ok = (dE < stabilityThreshold) ? ok+1 : 0;
-            prevKE = KE;
+            ok = monitor.sample(particles).stable ? ok+1 : 0;
             lastCheck = t;
         }
     }
@@ -300,6 +566,180 @@ static void settleUntilStable(b2WorldId worldId,
 
 
 
+b2BodyId createParticleBody(b2WorldId worldId, ParticleShapeType type, float size, int numSides,
+                            bool isOriginal, b2Vec2 position, b2Rot rotation)
+{
+    b2BodyDef particleDef = b2DefaultBodyDef();
+    particleDef.type = b2_dynamicBody;
+    particleDef.position = position;
+    particleDef.rotation = rotation;
+    particleDef.isBullet = false;
+    b2BodyId particleId = b2CreateBody(worldId, &particleDef);
+
+    b2ShapeDef particleShapeDef = b2DefaultShapeDef();
+    particleShapeDef.density = Density;
+    particleShapeDef.material.friction = 0.5f;
+    particleShapeDef.material.restitution = 0.9f;
+    particleShapeDef.enableSensorEvents = USE_EXIT_SENSORS;
+
+    if (type == CIRCLE) {
+        b2Circle circle = {};
+        circle.radius = size;
+        b2CreateCircleShape(particleId, &particleShapeDef, &circle);
+        numSides = 0;
+    } else {
+        // size = circunradio; numSides ya acotado a BOX2D_MAX_POLYGON_VERTICES
+        b2Vec2 vertices[BOX2D_MAX_POLYGON_VERTICES];
+        for (int j = 0; j < numSides; ++j) {
+            float a = 2.0f * (float)M_PI * j / numSides;
+            vertices[j] = (b2Vec2){size * std::cos(a), size * std::sin(a)};
+        }
+        b2Hull hull = b2ComputeHull(vertices, numSides);
+        b2Polygon polygonShape = b2MakePolygon(&hull, POLYGON_SKIN_RADIUS);
+        b2CreatePolygonShape(particleId, &particleShapeDef, &polygonShape);
+    }
+
+    b2MassData massData = b2Body_GetMassData(particleId);
+    particles.push_back({particleId, type, size, massData.mass, isOriginal, numSides});
+    particleBodyIds.push_back(particleId);
+    setParticleIndex(particleId, (int)particleBodyIds.size() - 1);
+    return particleId;
+}
+
+// =========================================================
+// DEPÓSITO BALÍSTICO (--packing-generator deposition)
+// =========================================================
+// Arma el empaquetamiento directamente dentro del silo, sin física: cada partícula se deja caer
+// en vertical desde la superficie del montón en DEPOSITION_TRIALS columnas/orientaciones al azar
+// y se queda en la de menor altura de reposo (primer contacto con el piso o con otra partícula).
+// Quedarse con la más baja rellena los huecos y, en polígonos, favorece apoyar una cara.
+// El resultado ya está casi en reposo: runSedimentation sólo hace la relajación final.
+static void depositParticles(b2WorldId worldId) {
+    const int   DEPOSITION_TRIALS = 8;
+    const int   BISECT_ITERS      = 12;
+
+    const float largeCircleRadius = BASE_RADIUS;
+    const float smallCircleRadius = BASE_RADIUS * SIZE_RATIO;
+    float polyCircumRadius = 0.0f;
+    if (NUM_POLYGON_PARTICLES > 0) {
+        int ns = std::max(3, NUM_SIDES);
+        polyCircumRadius = POLYGON_PERIMETER / (2.0f * ns * std::sin((float)M_PI / ns));
+    }
+    const int polySides = std::min(std::max(3, NUM_SIDES), BOX2D_MAX_POLYGON_VERTICES);
+
+    std::vector<ParticleShapeType> types;
+    types.reserve(NUM_LARGE_CIRCLES + NUM_SMALL_CIRCLES + NUM_POLYGON_PARTICLES);
+    for (int i = 0; i < NUM_LARGE_CIRCLES;    ++i) types.push_back(CIRCLE);
+    for (int i = 0; i < NUM_SMALL_CIRCLES;    ++i) types.push_back(CIRCLE);
+    for (int i = 0; i < NUM_POLYGON_PARTICLES;++i) types.push_back(POLYGON);
+    if (types.empty()) {
+        std::cout << "Sin partículas para crear.\n";
+        return;
+    }
+    RandomStream& placementRng = rng(RNG_PLACEMENT);
+    std::shuffle(types.begin(), types.end(), placementRng);
+
+    // Radios extremos: la celda cubre el diámetro máximo y el paso de caída no atraviesa
+    // la partícula más chica (radio inscripto en polígonos)
+    float maxR = 0.0f, minR = 1e30f;
+    if (NUM_LARGE_CIRCLES > 0) { maxR = std::max(maxR, largeCircleRadius); minR = std::min(minR, largeCircleRadius); }
+    if (NUM_SMALL_CIRCLES > 0) { maxR = std::max(maxR, smallCircleRadius); minR = std::min(minR, smallCircleRadius); }
+    if (NUM_POLYGON_PARTICLES > 0) {
+        maxR = std::max(maxR, polyCircumRadius);
+        minR = std::min(minR, polyCircumRadius * std::cos((float)M_PI / polySides));
+    }
+    const float cellSize = std::max(2.0f * maxR, 1e-4f);
+    const float fallStep = 0.2f * minR;
+
+    const float halfW = SILO_WIDTH / 2.0f;
+    PlacementGrid grid;
+    grid.reset(-halfW, GROUND_LEVEL_Y, halfW, GROUND_LEVEL_Y + silo_height + 2.0f * maxR, cellSize);
+
+    // Altura de la superficie por columna (tope de las partículas con centro en la columna)
+    const int numColumns = std::max(1, (int)std::ceil(SILO_WIDTH / cellSize));
+    std::vector<float> columnTop(numColumns, GROUND_LEVEL_Y);
+    auto columnOf = [&](float x) {
+        return std::min(numColumns - 1, std::max(0, (int)std::floor((x + halfW) / cellSize)));
+    };
+
+    int nLargeRemaining = NUM_LARGE_CIRCLES;
+    float pileTop = GROUND_LEVEL_Y;
+
+    for (ParticleShapeType t : types) {
+        bool isLarge = false;
+        if (t == CIRCLE) {
+            isLarge = (nLargeRemaining > 0);
+            if (isLarge) --nLargeRemaining;
+        }
+        const float R     = (t == CIRCLE) ? (isLarge ? largeCircleRadius : smallCircleRadius) : polyCircumRadius;
+        const int   sides = (t == CIRCLE) ? 0 : polySides;
+
+        float bestX = 0.0f, bestY = 1e30f, bestAng = 0.0f, bestContact = 0.0f;
+        for (int trial = 0; trial < DEPOSITION_TRIALS; ++trial) {
+            const float x   = placementRng.uniform(-halfW + R, halfW - R);
+            const float ang = (t == CIRCLE) ? 0.0f : placementRng.uniform(0.0f, 2.0f * (float)M_PI);
+            const float c = std::cos(ang), s = std::sin(ang);
+
+            // Distancia del centro al punto más bajo (circunradio en círculos)
+            float bottom = R;
+            if (sides > 0) {
+                bottom = 0.0f;
+                for (int j = 0; j < sides; ++j) {
+                    const float a = 2.0f * (float)M_PI * j / sides;
+                    bottom = std::max(bottom, -R * (s * std::cos(a) + c * std::sin(a)));
+                }
+            }
+            const float floorY = GROUND_LEVEL_Y + bottom;
+
+            // Arranque libre: por encima de todo lo que puede tocar en su recorrido
+            float startY = floorY;
+            for (int col = columnOf(x - R - maxR); col <= columnOf(x + R + maxR); ++col) {
+                startY = std::max(startY, columnTop[col] + R + 1e-4f);
+            }
+
+            // Caída a pasos hasta el primer contacto (o el piso)
+            float free = startY, y = startY;
+            while (true) {
+                const float next = std::max(floorY, y - fallStep);
+                if (next == y || grid.overlaps(x, next, c, s, R, sides)) break;
+                free = next;
+                y = next;
+            }
+            if (free < bestY) {
+                bestX = x; bestY = free; bestAng = ang;
+                bestContact = std::max(floorY, free - fallStep);   // primera altura con contacto
+            }
+        }
+
+        // Refinamiento del contacto sólo para la columna elegida: bisección entre la última
+        // altura libre y la primera con contacto (iguales si llegó al piso)
+        const float c = std::cos(bestAng), s = std::sin(bestAng);
+        float lo = bestContact, hi = bestY;
+        for (int it = 0; it < BISECT_ITERS && lo < hi; ++it) {
+            const float mid = 0.5f * (lo + hi);
+            if (grid.overlaps(bestX, mid, c, s, R, sides)) lo = mid; else hi = mid;
+        }
+        const float restY = hi;
+
+        grid.add(bestX, restY, c, s, R, sides);
+        const int col = columnOf(bestX);
+        columnTop[col] = std::max(columnTop[col], restY + R);
+        pileTop = std::max(pileTop, restY + R);
+
+        createParticleBody(worldId, t, R, sides, (t == CIRCLE) ? isLarge : true,
+                           (b2Vec2){bestX, restY}, (b2Rot){c, s});
+    }
+
+    stateSnapshot.captureAll(particles);
+
+    std::cout << "Depósito balístico: " << particles.size() << " partículas, altura del montón "
+              << pileTop << " m";
+    if (pileTop > GROUND_LEVEL_Y + silo_height) {
+        std::cout << " (Advertencia: supera la altura del silo " << silo_height << " m)";
+    }
+    std::cout << "\n";
+}
+
 void createParticles(b2WorldId worldId) {
 
     // =================== Parámetros de generación por tandas ===================
@@ -314,7 +754,7 @@ void createParticles(b2WorldId worldId) {
     // (Si tu firma de b2World_Step difiere, adaptá abajo la llamada.)
     auto relaxWorld = [&](int nSteps){
         for (int s = 0; s < nSteps; ++s){
-            b2World_Step(worldId, GEN_RELAX_DT, GEN_SUB_STEPS);
+            stepWorld(worldId, GEN_RELAX_DT, GEN_SUB_STEPS);
         }
     };
     // ==========================================================================
@@ -322,133 +762,21 @@ void createParticles(b2WorldId worldId) {
     particles.clear();
     particleBodyIds.clear();
 
+    if (PACKING_GENERATOR == PACKING_GENERATOR_DEPOSITION) {
+        depositParticles(worldId);
+        return;
+    }
+
     const float largeCircleRadius = BASE_RADIUS;
     const float smallCircleRadius = BASE_RADIUS * SIZE_RATIO;
 
-    // --------- util local: 2D, SAT, grilla ----------
-    struct Vec2 {
-        float x, y;
-        Vec2() : x(0), y(0) {}
-        Vec2(float X, float Y) : x(X), y(Y) {}
-        Vec2 operator+(const Vec2& o) const { return {x+o.x, y+o.y}; }
-        Vec2 operator-(const Vec2& o) const { return {x-o.x, y-o.y}; }
-    };
-    auto dot = [](const Vec2& a, const Vec2& b){ return a.x*b.x + a.y*b.y; };
-    auto length2 = [&](const Vec2& v){ return dot(v,v); };
-
-    struct Poly {
-        std::vector<Vec2> local; // CCW
-        float R = 0.f;           // circunradio
-    };
-    auto make_regular_ngon = [&](int n, float R){
-        Poly p; p.local.resize(n); p.R = R;
-        for (int i=0;i<n;++i){
-            float a = 2.0f*(float)M_PI*i/n;
-            p.local[i] = {R*std::cos(a), R*std::sin(a)};
-        }
-        return p;
-    };
-    auto poly_from_circumradius = [&](int sides, float R){
-        if (sides < 3) sides = 3;
-        return make_regular_ngon(sides, R);
-    };
-    auto worldVerts = [&](const Poly& P, const Vec2& pos, float ang){
-        float c = std::cos(ang), s = std::sin(ang);
-        std::vector<Vec2> out; out.reserve(P.local.size());
-        for (auto &v : P.local){
-            Vec2 r{ c*v.x - s*v.y, s*v.x + c*v.y };
-            out.push_back(r + pos);
-        }
-        return out;
-    };
-
-    // === SAT (ejes normalizados + EPS) ===
-    auto projectOnAxisNorm = [&](const std::vector<Vec2>& V, const Vec2& axisNorm,
-                                 float& minP, float& maxP){
-        float p0 = dot(V[0], axisNorm);
-        minP = maxP = p0;
-        for (size_t i=1;i<V.size();++i){
-            float p = dot(V[i], axisNorm);
-            if (p < minP) minP = p;
-            if (p > maxP) maxP = p;
-        }
-    };
-
-    auto overlapSAT = [&](const std::vector<Vec2>& A, const std::vector<Vec2>& B)->bool{
-        const float EPS = 1e-5f;
-        auto testAxes = [&](const std::vector<Vec2>& V)->bool{
-            for (size_t i=0;i<V.size();++i){
-                Vec2 p0 = V[i];
-                Vec2 p1 = V[(i+1)%V.size()];
-                Vec2 e{p1.x - p0.x, p1.y - p0.y};
-                float len = std::sqrt(e.x*e.x + e.y*e.y);
-                if (len <= 0.0f) continue;
-                Vec2 axisNorm{-e.y/len, e.x/len};
-                float minA, maxA, minB, maxB;
-                projectOnAxisNorm(A, axisNorm, minA, maxA);
-                projectOnAxisNorm(B, axisNorm, minB, maxB);
-                if (maxA <= minB + EPS || maxB <= minA + EPS) return false;
-            }
-            return true;
-        };
-        return testAxes(A) && testAxes(B);
-    };
-
-    struct CellKey { int cx, cy; };
-    struct CellKeyHash {
-        size_t operator()(const CellKey& k) const noexcept {
-            return std::hash<long long>()(((long long)k.cx<<32) ^ (long long)(k.cy));
-        }
-    };
-    struct CellKeyEq {
-        bool operator()(const CellKey& a, const CellKey& b) const noexcept {
-            return a.cx==b.cx && a.cy==b.cy;
-        }
-    };
-    auto cellOf = [&](const Vec2& p, float cellSize){
-        int cx = (int)std::floor(p.x / cellSize);
-        int cy = (int)std::floor(p.y / cellSize);
-        return CellKey{cx, cy};
-    };
-
-    // --------- catálogo de formas ----------
-    const int N_DISK = 20; // disco como 20-gon para precolocación
-
     float polyCircumRadius = 0.0f;
     if (NUM_POLYGON_PARTICLES > 0) {
         int ns = std::max(3, NUM_SIDES);
         polyCircumRadius = POLYGON_PERIMETER / (2.0f * ns * std::sin((float)M_PI / ns));
     }
-
-    std::vector<Poly> catalog;
-    int CAT_LARGE_DISK = -1, CAT_SMALL_DISK = -1, CAT_POLY = -1;
-
-    if (NUM_LARGE_CIRCLES > 0) {
-        CAT_LARGE_DISK = (int)catalog.size();
-        catalog.push_back(make_regular_ngon(N_DISK, largeCircleRadius));
-    }
-    if (NUM_SMALL_CIRCLES > 0) {
-        CAT_SMALL_DISK = (int)catalog.size();
-        catalog.push_back(make_regular_ngon(N_DISK, smallCircleRadius));
-    }
-    if (NUM_POLYGON_PARTICLES > 0) {
-        CAT_POLY = (int)catalog.size();
-        catalog.push_back(poly_from_circumradius(std::max(3, NUM_SIDES), polyCircumRadius));
-    }
-
-    if ((int)catalog.size() == 0 && TOTAL_PARTICLES == 0) {
-        std::cout << "Sin partículas para crear.\n";
-        return;
-    }
-
-    // Radio máximo para grilla
-    float maxR = 0.f;
-    for (auto &p : catalog) maxR = std::max(maxR, p.R);
-    if (maxR <= 0.f) {
-        maxR = std::max(largeCircleRadius, std::max(smallCircleRadius, polyCircumRadius));
-    }
-    const float cellSize  = std::max(2.0f*maxR, 1e-4f);
-    const float clearance = 1.02f;
+    // Lados reales del cuerpo (createParticleBody) para que la prueba coincida con Box2D
+    const int polySides = std::min(std::max(3, NUM_SIDES), BOX2D_MAX_POLYGON_VERTICES);
 
     // --------- pool de tipos a crear ----------
     std::vector<ParticleShapeType> particleTypesToCreate;
@@ -456,7 +784,20 @@ void createParticles(b2WorldId worldId) {
     for (int i = 0; i < NUM_LARGE_CIRCLES;    ++i) particleTypesToCreate.push_back(CIRCLE);
     for (int i = 0; i < NUM_SMALL_CIRCLES;    ++i) particleTypesToCreate.push_back(CIRCLE);
     for (int i = 0; i < NUM_POLYGON_PARTICLES;++i) particleTypesToCreate.push_back(POLYGON);
-    std::shuffle(particleTypesToCreate.begin(), particleTypesToCreate.end(), randomEngine);
+    const int totalToCreate = (int)particleTypesToCreate.size();
+    if (totalToCreate == 0) {
+        std::cout << "Sin partículas para crear.\n";
+        return;
+    }
+    RandomStream& placementRng = rng(RNG_PLACEMENT);
+    std::shuffle(particleTypesToCreate.begin(), particleTypesToCreate.end(), placementRng);
+
+    // Radio máximo (celda de la grilla = diámetro máximo)
+    float maxR = 0.f;
+    if (NUM_LARGE_CIRCLES > 0)     maxR = std::max(maxR, largeCircleRadius);
+    if (NUM_SMALL_CIRCLES > 0)     maxR = std::max(maxR, smallCircleRadius);
+    if (NUM_POLYGON_PARTICLES > 0) maxR = std::max(maxR, polyCircumRadius);
+    const float cellSize = std::max(2.0f*maxR, 1e-4f);
 
     // Caja global disponible
     float Rmax_place = std::max(largeCircleRadius, std::max(smallCircleRadius, polyCircumRadius));
@@ -467,25 +808,17 @@ void createParticles(b2WorldId worldId) {
     // Banda superior para spawnear (más angosta en Y)
     const float bandTop    = GROUND_LEVEL_Y + silo_height - pad;
     const float bandBottom = std::max(GROUND_LEVEL_Y + pad, bandTop - SPAWN_BAND_HEIGHT);
+    const float escapeY    = bandTop + 3.0f*maxR;
 
-    std::uniform_real_distribution<float> Ux(minX_gen, maxX_gen);
-    std::uniform_real_distribution<float> Uy(bandBottom, bandTop);
-    std::uniform_real_distribution<float> Uang(0.f, 2.f*(float)M_PI);
-
-    // Mapeo tipo -> índice de catálogo y circunradio
-    auto getCatalogIndexAndR = [&](ParticleShapeType t, bool isLargeCircle)->std::pair<int,float>{
-        if (t == CIRCLE) {
-            if (isLargeCircle) return {CAT_LARGE_DISK, largeCircleRadius};
-            else               return {CAT_SMALL_DISK, smallCircleRadius};
-        } else {
-            return {CAT_POLY, polyCircumRadius};
-        }
-    };
-
-    struct Placed { Vec2 pos; float ang; ParticleShapeType t; bool large; };
+    auto Ux   = [&]() { return placementRng.uniform(minX_gen, maxX_gen); };
+    auto Uy   = [&]() { return placementRng.uniform(bandBottom, bandTop); };
+    auto Uang = [&]() { return placementRng.uniform(0.f, 2.f*(float)M_PI); };
 
-    std::vector<Placed> placed; placed.reserve(TOTAL_PARTICLES);
-    std::unordered_map<CellKey, std::vector<int>, CellKeyHash, CellKeyEq> grid;
+    // Grilla plana sobre la banda de spawneo: una partícula más abajo que bandBottom - 2*maxR
+    // no puede tocar a ninguna candidata
+    const float gridMinY = bandBottom - 2.0f*maxR;
+    PlacementGrid grid;
+    grid.reset(-SILO_WIDTH / 2.0f, gridMinY, SILO_WIDTH / 2.0f, escapeY + maxR, cellSize);
 
     const int MAX_ATTEMPTS = 2000;
 
@@ -493,8 +826,17 @@ void createParticles(b2WorldId worldId) {
     int nSmallRemaining = NUM_SMALL_CIRCLES;
 
     // =================== BUCLE POR TANDAS ===================
-    for (int base = 0; base < TOTAL_PARTICLES; base += GEN_BATCH_SIZE) {
-        int batchEnd = std::min(base + GEN_BATCH_SIZE, TOTAL_PARTICLES);
+    for (int base = 0; base < totalToCreate; base += GEN_BATCH_SIZE) {
+        int batchEnd = std::min(base + GEN_BATCH_SIZE, totalToCreate);
+
+        // Partículas de tandas previas en su posición actual (ya cayeron durante el relax)
+        const StateSnapshot& S = stateSnapshot;
+        grid.clear();
+        for (size_t k = 0; k < S.size(); ++k) {
+            if (S.y[k] < gridMinY) continue;
+            grid.stage(S.x[k], S.y[k], S.cosA[k], S.sinA[k], particles[k].size, particles[k].numSides);
+        }
+        grid.build();
 
         for (int i = base; i < batchEnd; ++i) {
             ParticleShapeType t = particleTypesToCreate[i];
@@ -503,154 +845,48 @@ void createParticles(b2WorldId worldId) {
                 if (nLargeRemaining > 0) { isLarge = true;  --nLargeRemaining; }
                 else                     { isLarge = false; --nSmallRemaining; }
             }
-
-            auto [catIdx, Rcur] = getCatalogIndexAndR(t, isLarge);
-            if (catIdx < 0) { // fallback
-                catIdx = CAT_SMALL_DISK;
-                Rcur = smallCircleRadius;
-                t = CIRCLE; isLarge = false;
-            }
-            const Poly& P = catalog[catIdx];
+            const float Rcur  = (t == CIRCLE) ? (isLarge ? largeCircleRadius : smallCircleRadius) : polyCircumRadius;
+            const int   sides = (t == CIRCLE) ? 0 : polySides;
 
             bool ok = false;
             int attempts = 0;
-            Vec2 pos;
-            float ang = Uang(randomEngine); // también para círculos (20-gon del SAT)
+            b2Vec2 pos = {0.0f, 0.0f};
+            float ang = Uang();
 
             while (!ok && attempts < MAX_ATTEMPTS) {
                 ++attempts;
 
                 // Elegimos dentro de la banda superior para que caigan
-                pos = {Ux(randomEngine), Uy(randomEngine)};
-                if (t != CIRCLE) ang = Uang(randomEngine);
-
-                // broad-phase con grilla (considera TODO lo ya colocado en tandas previas)
-                bool overlaps = false;
-                CellKey c = cellOf(pos, cellSize);
-                for (int dy=-1; dy<=1 && !overlaps; ++dy){
-                    for (int dx=-1; dx<=1 && !overlaps; ++dx){
-                        CellKey nb{c.cx+dx, c.cy+dy};
-                        auto it = grid.find(nb);
-                        if (it == grid.end()) continue;
-                        for (int idx : it->second){
-                            const Placed& Q = placed[idx];
-                            auto [catIdxQ, RQ] = getCatalogIndexAndR(Q.t, Q.large);
-                            const Poly& PQ = catalog[catIdxQ];
-
-                            float Rsum = clearance*(P.R + PQ.R);
-                            Vec2 d{pos.x - Q.pos.x, pos.y - Q.pos.y};
-                            if (length2(d) > Rsum*Rsum) continue;
-
-                            auto A = worldVerts(P, pos, ang);
-                            auto B = worldVerts(PQ, Q.pos, Q.ang);
-                            if (overlapSAT(A, B)) { overlaps = true; break; }
-                        }
-                    }
-                }
+                pos = {Ux(), Uy()};
+                if (t != CIRCLE) ang = Uang();
 
-                if (!overlaps) {
-                    int newIndex = (int)placed.size();
-                    placed.push_back({pos, ang, t, isLarge});
-                    grid[c].push_back(newIndex);
+                // Se prueba con la rotación que recibe el cuerpo
+                b2Rot rot = { std::cos(ang/2.0f), std::sin(ang/2.0f) };
+                if (!grid.overlaps(pos.x, pos.y, rot.c, rot.s, Rcur, sides)) {
+                    grid.add(pos.x, pos.y, rot.c, rot.s, Rcur, sides);
 
                     // ========= Crear cuerpo inmediatamente (por tanda) =========
-                    b2BodyDef particleDef = b2DefaultBodyDef();
-                    particleDef.type = b2_dynamicBody;
-                    particleDef.position = (b2Vec2){pos.x, pos.y};
-                    b2Rot rot = { std::cos(ang/2.0f), std::sin(ang/2.0f) };
-                    particleDef.rotation = rot;
-                    particleDef.isBullet = false;
-                    b2BodyId particleId = b2CreateBody(worldId, &particleDef);
-
-                    b2ShapeDef particleShapeDef = b2DefaultShapeDef();
-                    particleShapeDef.density = Density;
-                    particleShapeDef.material.friction = 0.5f;
-                    particleShapeDef.material.restitution = 0.9f;
-
-                    if (t == CIRCLE) {
-                        float r = isLarge ? largeCircleRadius : smallCircleRadius;
-                        b2Circle circle = {};
-                        circle.radius = r;
-                        b2CreateCircleShape(particleId, &particleShapeDef, &circle);
-
-                        b2MassData massData = b2Body_GetMassData(particleId);
-                        particles.push_back({particleId, CIRCLE, r, massData.mass, isLarge, 0});
-                    } else {
-                        int ns = std::max(3, NUM_SIDES);
-                        float R = polyCircumRadius;
-                        const float POLYGON_SKIN_RADIUS = 0.0f;
-
-                        b2Vec2 vertices[BOX2D_MAX_POLYGON_VERTICES];
-                        int actualNumSides = std::min(ns, BOX2D_MAX_POLYGON_VERTICES);
-                        for (int j = 0; j < actualNumSides; ++j) {
-                            float a = 2.0f * (float)M_PI * j / actualNumSides;
-                            vertices[j] = (b2Vec2){R * std::cos(a), R * std::sin(a)};
-                        }
-                        b2Hull hull = b2ComputeHull(vertices, actualNumSides);
-                        b2Polygon polygonShape = b2MakePolygon(&hull, POLYGON_SKIN_RADIUS);
-                        b2CreatePolygonShape(particleId, &particleShapeDef, &polygonShape);
-
-                        b2MassData massData = b2Body_GetMassData(particleId);
-                        particles.push_back({particleId, POLYGON, R, massData.mass, true, actualNumSides});
-                    }
-
-                    particleBodyIds.push_back(particleId);
+                    createParticleBody(worldId, t, Rcur, sides, (t == CIRCLE) ? isLarge : true,
+                                       (b2Vec2){pos.x, pos.y}, rot);
                     ok = true;
                 }
             }
 
             if (!ok) {
                 // escape: spawnear un poco por encima de la banda y dejar caer
-                Vec2 posEsc = {Ux(randomEngine), bandTop + 3.0f*maxR};
-                float angEsc = Uang(randomEngine);
+                b2Vec2 posEsc = {Ux(), escapeY};
+                float angEsc = Uang();
 
-                int newIndex = (int)placed.size();
-                placed.push_back({posEsc, angEsc, t, isLarge});
-                grid[cellOf(posEsc, cellSize)].push_back(newIndex);
-
-                b2BodyDef particleDef = b2DefaultBodyDef();
-                particleDef.type = b2_dynamicBody;
-                particleDef.position = (b2Vec2){posEsc.x, posEsc.y};
                 b2Rot rot = { std::cos(angEsc/2.0f), std::sin(angEsc/2.0f) };
-                particleDef.rotation = rot;
-                particleDef.isBullet = false;
-                b2BodyId particleId = b2CreateBody(worldId, &particleDef);
-
-                b2ShapeDef particleShapeDef = b2DefaultShapeDef();
-                particleShapeDef.density = Density;
-                particleShapeDef.material.friction = 0.5f;
-                particleShapeDef.material.restitution = 0.9f;
-
-                if (t == CIRCLE) {
-                    float r = isLarge ? largeCircleRadius : smallCircleRadius;
-                    b2Circle circle = {};
-                    circle.radius = r;
-                    b2CreateCircleShape(particleId, &particleShapeDef, &circle);
-
-                    b2MassData massData = b2Body_GetMassData(particleId);
-                    particles.push_back({particleId, CIRCLE, r, massData.mass, isLarge, 0});
-                } else {
-                    int ns = std::max(3, NUM_SIDES);
-                    float R = polyCircumRadius;
-                    const float POLYGON_SKIN_RADIUS = 0.0f;
-
-                    b2Vec2 vertices[BOX2D_MAX_POLYGON_VERTICES];
-                    int actualNumSides = std::min(ns, BOX2D_MAX_POLYGON_VERTICES);
-                    for (int j = 0; j < actualNumSides; ++j) {
-                        float a = 2.0f * (float)M_PI * j / actualNumSides;
-                        vertices[j] = (b2Vec2){R * std::cos(a), R * std::sin(a)};
-                    }
-                    b2Hull hull = b2ComputeHull(vertices, actualNumSides);
-                    b2Polygon polygonShape = b2MakePolygon(&hull, POLYGON_SKIN_RADIUS);
-                    b2CreatePolygonShape(particleId, &particleShapeDef, &polygonShape);
-
-                    b2MassData massData = b2Body_GetMassData(particleId);
-                    particles.push_back({particleId, POLYGON, R, massData.mass, true, actualNumSides});
-                }
-                particleBodyIds.push_back(particleId);
+                grid.add(posEsc.x, posEsc.y, rot.c, rot.s, Rcur, sides);
+                createParticleBody(worldId, t, Rcur, sides, (t == CIRCLE) ? isLarge : true,
+                                   (b2Vec2){posEsc.x, posEsc.y}, rot);
             }
         } // fin for i en tanda
 
+        // Cuerpos nuevos de la tanda: la foto se relee completa antes de relajar
+        stateSnapshot.captureAll(particles);
+
         // --------- Relax: dejamos caer y acomodar antes de la próxima tanda ----------
         // relaxWorld(GEN_RELAX_STEPS);
         settleUntilStable(worldId, /*maxTime*/ 1.5f, /*checkInterval*/ 0.5f,
@@ -670,57 +906,27 @@ bool runSedimentation(b2WorldId worldId) {
     const float STABILITY_CHECK_INTERVAL = 0.5f;
     const int   REQUIRED_CHECKS          = 3;
 
-    const float KE_ABS_PER_PART_EPS      = 1e-3f;
-    const float KE_DELTA_EPS             = 1e-2f;
-    const float V_SLOW_EPS               = 0.05f;
-    const float W_SLOW_EPS               = 0.2f;
-    const float SLOW_FRACTION_REQUIRED   = 0.95f;
-
-    float Rmax = BASE_RADIUS;
-    if (SIZE_RATIO > 0.f) Rmax = std::max(Rmax, BASE_RADIUS * SIZE_RATIO);
-    if (NUM_POLYGON_PARTICLES > 0 && NUM_SIDES >= 3) {
-        float ns = std::max(3, NUM_SIDES);
-        float polyR = POLYGON_PERIMETER / (2.0f * ns * std::sin(float(M_PI)/ns));
-        Rmax = std::max(Rmax, polyR);
-    }
-    const float pad = Rmax + 0.01f;
-    const float bandTop    = GROUND_LEVEL_Y + silo_height - pad;
-    const float bandMargin = 2.0f * Rmax;
-    const float yCeiling   = bandTop - bandMargin;
+    StabilityCriteria criteria = sedimentationCriteria();
+    criteria.keDelta = 1e-2f;
+    StabilityMonitor monitor(criteria);
 
     float t = 0.0f, lastCheck = 0.0f;
-    float prevKE = 1e9f;
     int stableCount = 0;
 
     while (t < MAX_SEDIMENTATION_TIME) {
-        b2World_Step(worldId, TIME_STEP, SUB_STEP_COUNT);
+        stepWorld(worldId, TIME_STEP, SUB_STEP_COUNT);
         t += TIME_STEP;
 
-        if (t - lastCheck >= STABILITY_CHECK_INTERVAL) {
-            float KE = 0.0f;
-            int slowCount = 0;
-            float yMax = -1e30f;
-
-            for (const auto& p : particles) {
-                b2Vec2 v = b2Body_GetLinearVelocity(p.bodyId);
-                float w  = b2Body_GetAngularVelocity(p.bodyId);
-                KE += 0.5f * p.mass * (v.x*v.x + v.y*v.y);
-                if (std::sqrt(v.x*v.x + v.y*v.y) < V_SLOW_EPS && std::fabs(w) < W_SLOW_EPS)
-                    ++slowCount;
-                b2Vec2 pos = b2Body_GetPosition(p.bodyId);
-                if (pos.y > yMax) yMax = pos.y;
-            }
-
-            const float KE_per_part = (TOTAL_PARTICLES > 0) ? KE / TOTAL_PARTICLES : 0.0f;
-            const float dKE         = std::fabs(KE - prevKE);
-            const float slowFrac    = (TOTAL_PARTICLES > 0) ? float(slowCount) / TOTAL_PARTICLES : 1.0f;
-            const bool  bandClear   = (yMax <= yCeiling);
-
-            bool stableKinetics = (KE_per_part < KE_ABS_PER_PART_EPS &&
-                                   dKE         < KE_DELTA_EPS &&
-                                   slowFrac    >= SLOW_FRACTION_REQUIRED);
+        // Box2D durmió a todos: chequeo inmediato, sin esperar el intervalo ni repetir chequeos
+        const bool quiescent = particlesQuiescent();
 
-            if (stableKinetics && bandClear) {
+        if (quiescent || t - lastCheck >= STABILITY_CHECK_INTERVAL) {
+            const StabilitySample s = monitor.sample(particles);
+            if (s.quiescent && s.stable) {
+                std::cout << "Estabilización completa en " << t << " s (todas las partículas dormidas)\n";
+                return true;
+            }
+            if (s.stable) {
                 if (++stableCount >= REQUIRED_CHECKS) {
                     std::cout << "Estabilización completa en " << t << " s\n";
                     return true;
@@ -728,8 +934,6 @@ bool runSedimentation(b2WorldId worldId) {
             } else {
                 stableCount = 0;
             }
-
-            prevKE   = KE;
             lastCheck = t;
         }
     }
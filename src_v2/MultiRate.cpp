@@ -0,0 +1,110 @@
+// src/MultiRate.cpp
+
+#include "MultiRate.h"
+#include "StateSnapshot.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float MULTIRATE_MAX_DRIFT = 0.05f;   // deriva máx. retenida / radio mínimo
+
+} // namespace
+
+// =========================================================
+// INICIALIZACIÓN
+// =========================================================
+
+void MultiRateController::reset(b2WorldId worldId, const std::vector<ParticleInfo>& particles) {
+    // Radio mínimo: discos por su radio, polígonos por su inradio (R cos(pi/n))
+    minRadius_ = 1e30f;
+    for (const auto& p : particles) {
+        float r = p.size;
+        if (p.shapeType == POLYGON && p.numSides >= 3) {
+            r = p.size * std::cos(float(M_PI) / p.numSides);
+        }
+        minRadius_ = std::min(minRadius_, r);
+    }
+    if (minRadius_ >= 1e30f) minRadius_ = BASE_RADIUS;
+
+    ratio_    = std::max(1, MULTIRATE_RATIO);
+    phase_    = 0;
+    zoneTop_  = GROUND_LEVEL_Y + MULTIRATE_ZONE * OUTLET_WIDTH;
+    heldTime_ = 0.0f;
+    gravity_  = b2World_GetGravity(worldId);
+    restSpeed_ = b2DefaultBodyDef().sleepThreshold;
+
+    heldVx_.assign(particles.size(), 0.0f);
+    heldVy_.assign(particles.size(), 0.0f);
+    heldW_.assign(particles.size(), 0.0f);
+    heldList_.clear();
+    heldBodySteps_ = totalBodySteps_ = 0;
+}
+
+// =========================================================
+// RETENCIÓN / LIBERACIÓN
+// =========================================================
+
+void MultiRateController::hold(float dt, const std::vector<ParticleInfo>& particles) {
+    StateSnapshot& S = stateSnapshot;
+    S.refreshVelocities(particles);
+    const int n = (int)std::min(particles.size(), S.size());
+
+    // Deriva permitida durante los k-1 pasos finos retenidos
+    const float vMax = MULTIRATE_MAX_DRIFT * minRadius_ / ((ratio_ - 1) * dt);
+    const float vMax2 = vMax * vMax;
+    const float vRest2 = restSpeed_ * restSpeed_;
+
+    // Sólo cuerpos despiertos y que no estén por dormirse: los dormidos no cuestan nada y
+    // retenerlos (y despertarlos al liberar) impediría que el volumen se duerma
+    for (int i : S.awakeList) {
+        if (i >= n || S.y[i] <= zoneTop_) continue;
+        const float v2 = S.vx[i]*S.vx[i] + S.vy[i]*S.vy[i];
+        if (v2 > vMax2 || std::fabs(S.w[i]) * particles[i].size > vMax) continue;
+        if (v2 < vRest2 && std::fabs(S.w[i]) * particles[i].size < restSpeed_) continue;
+
+        const b2BodyId body = particles[i].bodyId;
+        b2Body_SetType(body, b2_kinematicBody);
+        b2Body_SetLinearVelocity(body, {S.vx[i], S.vy[i]});
+        b2Body_SetAngularVelocity(body, S.w[i]);
+        heldVx_[i] = S.vx[i];
+        heldVy_[i] = S.vy[i];
+        heldW_[i]  = S.w[i];
+        heldList_.push_back(i);
+    }
+}
+
+void MultiRateController::release(const std::vector<ParticleInfo>& particles) {
+    // Velocidad retenida + impulso gravitatorio del intervalo; los contactos lo corrigen en el
+    // paso de borde. Todas estaban despiertas y en movimiento al retenerlas.
+    const b2Vec2 dv = {gravity_.x * heldTime_, gravity_.y * heldTime_};
+    for (int i : heldList_) {
+        const b2BodyId body = particles[i].bodyId;
+        b2Body_SetType(body, b2_dynamicBody);
+        b2Body_SetLinearVelocity(body, {heldVx_[i] + dv.x, heldVy_[i] + dv.y});
+        b2Body_SetAngularVelocity(body, heldW_[i]);
+        b2Body_SetAwake(body, true);
+    }
+    heldList_.clear();
+    heldTime_ = 0.0f;
+}
+
+// =========================================================
+// PASO
+// =========================================================
+
+void MultiRateController::beforeStep(const std::vector<ParticleInfo>& particles) {
+    if (phase_ == 0 && !heldList_.empty()) release(particles);
+}
+
+void MultiRateController::afterStep(float dt, const std::vector<ParticleInfo>& particles) {
+    heldBodySteps_  += (long long)heldList_.size();
+    totalBodySteps_ += (long long)particles.size();
+
+    if (phase_ == 0) {
+        if (ratio_ > 1) hold(dt, particles);
+    } else {
+        heldTime_ += dt;
+    }
+    phase_ = (phase_ + 1) % ratio_;
+}
@@ -0,0 +1,167 @@
+// src/PackingCache.cpp
+
+#include "PackingCache.h"
+#include "Constants.h"
+#include "Initialization.h"
+#include "StateSnapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include <functional>
+#include <vector>
+#include <unistd.h>
+
+namespace packing {
+
+namespace {
+
+// FNV-1a de 64 bits sobre la representación binaria de cada parámetro
+class KeyHasher {
+public:
+    template <typename T>
+    void add(const T& value) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            hash_ ^= p[i];
+            hash_ *= 0x100000001B3ull;
+        }
+    }
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_ = 0xCBF29CE484222325ull;
+};
+
+} // namespace
+
+// =========================================================
+// CLAVE Y RUTA
+// =========================================================
+
+uint64_t packingKey(uint64_t seed) {
+    KeyHasher h;
+    h.add(VERSION);
+    // Geometría del silo
+    h.add(SILO_WIDTH);
+    h.add(silo_height);
+    h.add(OUTLET_WIDTH);
+    // Mezcla de partículas
+    h.add(BASE_RADIUS);
+    h.add(SIZE_RATIO);
+    h.add(CHI);
+    h.add(NUM_LARGE_CIRCLES);
+    h.add(NUM_SMALL_CIRCLES);
+    h.add(NUM_POLYGON_PARTICLES);
+    h.add(NUM_SIDES);
+    h.add(POLYGON_PERIMETER);
+    // Generador del empaquetamiento
+    h.add(PACKING_GENERATOR);
+    // Semilla del empaquetamiento
+    h.add(seed);
+    return h.value();
+}
+
+std::string packingPath(uint64_t key) {
+    char name[40];
+    std::snprintf(name, sizeof(name), "packing_%016llx.bin", (unsigned long long)key);
+    return (std::filesystem::path(PACKING_CACHE_DIR) / name).string();
+}
+
+// =========================================================
+// FOTO EN MEMORIA
+// =========================================================
+
+void capturePacking(uint64_t key, Packing& out) {
+    stateSnapshot.refreshVelocities(particles);
+    const StateSnapshot& S = stateSnapshot;
+
+    out.key = key;
+    out.particles.resize(particles.size());
+    for (size_t i = 0; i < particles.size(); ++i) {
+        PackedParticle& p = out.particles[i];
+        p.type = (uint8_t)particles[i].shapeType;
+        p.isOriginal = particles[i].isOriginal ? 1 : 0;
+        p.sides = (uint8_t)particles[i].numSides;
+        p.reserved = 0;
+        p.size = particles[i].size;
+        p.x = S.x[i];
+        p.y = S.y[i];
+        p.cosA = S.cosA[i];
+        p.sinA = S.sinA[i];
+        p.vx = S.vx[i];
+        p.vy = S.vy[i];
+        p.w = S.w[i];
+    }
+}
+
+void restorePacking(b2WorldId worldId, const Packing& packing) {
+    particles.reserve(packing.particles.size());
+    particleBodyIds.reserve(packing.particles.size());
+    for (const PackedParticle& p : packing.particles) {
+        const b2BodyId bodyId = createParticleBody(
+            worldId, (ParticleShapeType)p.type, p.size, p.sides, p.isOriginal != 0,
+            (b2Vec2){p.x, p.y}, b2Rot{p.cosA, p.sinA});
+        b2Body_SetLinearVelocity(bodyId, (b2Vec2){p.vx, p.vy});
+        b2Body_SetAngularVelocity(bodyId, p.w);
+    }
+    stateSnapshot.captureAll(particles);
+}
+
+// =========================================================
+// ARCHIVOS DE LA CACHÉ
+// =========================================================
+
+bool loadPacking(b2WorldId worldId, uint64_t key) {
+    std::FILE* file = std::fopen(packingPath(key).c_str(), "rb");
+    if (!file) return false;
+
+    PackingFileHeader header;
+    Packing packing;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              header.version == VERSION && header.key == key &&
+              (int)header.particleCount == NUM_LARGE_CIRCLES + NUM_SMALL_CIRCLES + NUM_POLYGON_PARTICLES;
+    if (ok) {
+        packing.key = key;
+        packing.particles.resize(header.particleCount);
+        ok = std::fread(packing.particles.data(), sizeof(PackedParticle), packing.particles.size(), file)
+             == packing.particles.size();
+    }
+    std::fclose(file);
+    if (!ok) return false;
+
+    restorePacking(worldId, packing);
+    return true;
+}
+
+bool savePacking(uint64_t key) {
+    std::error_code ec;
+    std::filesystem::create_directories(PACKING_CACHE_DIR, ec);
+
+    Packing packing;
+    capturePacking(key, packing);
+
+    PackingFileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.particleCount = (uint32_t)packing.particles.size();
+    header.key = key;
+
+    // Temporal propio del proceso/hilo y rename atómico
+    const std::string path = packingPath(key);
+    const std::string tmpPath = path + ".tmp" + std::to_string((long long)::getpid()) + "_" +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(packing.particles.data(), sizeof(PackedParticle), packing.particles.size(), file)
+              == packing.particles.size();
+    ok = (std::fclose(file) == 0) && ok;
+    if (ok) ok = std::rename(tmpPath.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(tmpPath.c_str());
+    return ok;
+}
+
+} // namespace packing
@@ -0,0 +1,353 @@
+// src/ParameterSweep.cpp
+
+#include "ParameterSweep.h"
+#include "Initialization.h"
+#include "DataHandling.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Mapeo KEY -> flag del binario (el mismo de ejecutar_simulacion.sh)
+const std::map<std::string, std::string> PARAM_FLAGS = {
+    {"BASE_RADIUS", "--base-radius"},
+    {"CHI", "--chi"},
+    {"SIZE-RATIO", "--size-ratio"},
+    {"TOTAL_PARTICLES", "--total-particles"},
+    {"NUM_LARGE_CIRCLES", "--num-large-circles"},
+    {"NUM_SMALL_CIRCLES", "--num-small-circles"},
+    {"NUM_POLYGON_PARTICLES", "--num-polygon-particles"},
+    {"NUM_SIDES", "--num-sides"},
+    {"CURRENT_SIM", "--current-sim"},
+    {"TOTAL_SIMS", "--total-sims"},
+    {"SAVE_SIM_DATA", "--save-sim-data"},
+    {"SILO_HEIGHT", "--silo-height"},
+    {"SILO_WIDTH", "--silo-width"},
+    {"OUTLET_WIDTH", "--outlet-width"},
+    {"MAX_AVALANCHES", "--max-avalanches"},
+    {"EXIT_CHECK_EVERY_STEPS", "--exit-check-every"},
+    {"SAVE_FRAME_EVERY_STEPS", "--save-frame-every"},
+    {"THREADS", "--threads"},
+    {"PARALLEL_REPLICAS", "--parallel-replicas"},
+    {"SEED", "--seed"},
+    {"ADAPTIVE_DT", "--adaptive-dt"},
+    {"EXIT_SENSORS", "--exit-sensors"},
+    {"ASYNC_OUTPUT", "--async-output"},
+    {"FRAME_CODEC", "--frame-codec"},
+    {"FRAME_TOLERANCE", "--frame-tolerance"},
+    {"PACKING_CACHE", "--packing-cache"},
+    {"PACKING_SEED", "--packing-seed"},
+    {"FORK_DISCHARGES", "--fork-discharges"},
+    {"PACKING_GENERATOR", "--packing-generator"},
+    {"ARCH_DETECTION", "--arch-detection"},
+    {"JAM_CONFIRM_TIME", "--jam-confirm-time"},
+    {"JAM_FAST_FORWARD", "--jam-fast-forward"},
+    {"ROI_HEIGHT", "--roi-height"},
+    {"MULTIRATE", "--multirate"},
+    {"MULTIRATE_ZONE", "--multirate-zone"},
+    {"REINJECT_VELOCITY", "--reinject-velocity"},
+};
+
+std::string trim(const std::string& s) {
+    size_t b = 0, e = s.size();
+    while (b < e && std::isspace((unsigned char)s[b])) ++b;
+    while (e > b && std::isspace((unsigned char)s[e - 1])) --e;
+    return s.substr(b, e - b);
+}
+
+// Orden natural: las corridas de dígitos se comparan por valor (parametros_2 < parametros_10)
+bool naturalLess(const std::string& a, const std::string& b) {
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (std::isdigit((unsigned char)a[i]) && std::isdigit((unsigned char)b[j])) {
+            size_t ie = i, je = j;
+            while (ie < a.size() && std::isdigit((unsigned char)a[ie])) ++ie;
+            while (je < b.size() && std::isdigit((unsigned char)b[je])) ++je;
+            const std::string na = a.substr(i, ie - i), nb = b.substr(j, je - j);
+            const size_t za = na.find_first_not_of('0'), zb = nb.find_first_not_of('0');
+            const std::string va = (za == std::string::npos) ? "" : na.substr(za);
+            const std::string vb = (zb == std::string::npos) ? "" : nb.substr(zb);
+            if (va.size() != vb.size()) return va.size() < vb.size();
+            if (va != vb) return va < vb;
+            i = ie; j = je;
+        } else {
+            if (a[i] != b[j]) return a[i] < b[j];
+            ++i; ++j;
+        }
+    }
+    return (a.size() - i) < (b.size() - j);
+}
+
+// Archivos del barrido: los .txt de un directorio o las líneas de un manifiesto
+bool listParameterFiles(const std::string& source, std::vector<std::string>& files) {
+    std::error_code ec;
+    if (fs::is_directory(source, ec)) {
+        for (const auto& entry : fs::directory_iterator(source, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end(), naturalLess);
+        return true;
+    }
+
+    std::ifstream manifest(source);
+    if (!manifest) {
+        std::cerr << "Error: --sweep: no se pudo abrir " << source << "\n";
+        return false;
+    }
+    const fs::path base = fs::path(source).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        const fs::path p(line);
+        files.push_back((p.is_absolute() ? p : base / p).string());
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// Colas con robo de trabajo (una por hilo)
+// ---------------------------------------------------------
+
+struct SweepTask {
+    int set;
+    int replica;        // índice de simulación
+};
+
+struct SweepQueue {
+    std::mutex mutex;
+    std::deque<SweepTask> tasks;
+};
+
+// El dueño toma del fondo; un hilo sin trabajo roba del frente de la cola más cargada
+bool popOrSteal(std::vector<std::unique_ptr<SweepQueue>>& queues, int self,
+                SweepTask& out, bool& stolen) {
+    {
+        SweepQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = own.tasks.back();
+            own.tasks.pop_back();
+            stolen = false;
+            return true;
+        }
+    }
+    while (true) {
+        int victim = -1;
+        size_t most = 0;
+        for (int q = 0; q < (int)queues.size(); ++q) {
+            if (q == self) continue;
+            std::lock_guard<std::mutex> lock(queues[q]->mutex);
+            if (queues[q]->tasks.size() > most) {
+                most = queues[q]->tasks.size();
+                victim = q;
+            }
+        }
+        if (victim < 0) return false;
+
+        SweepQueue& v = *queues[victim];
+        std::lock_guard<std::mutex> lock(v.mutex);
+        if (v.tasks.empty()) continue;   // otro ladrón se adelantó
+        out = v.tasks.front();
+        v.tasks.pop_front();
+        stolen = true;
+        return true;
+    }
+}
+
+} // namespace
+
+// =========================================================
+// LECTURA DE ARCHIVOS DE PARÁMETROS
+// =========================================================
+
+bool readParameterFile(const std::string& path, std::vector<std::string>& args) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Error: no se pudo abrir el archivo de parámetros " << path << "\n";
+        return false;
+    }
+
+    // Como el script: KEY=VALUE, # comenta, espacios laterales recortados, la última gana
+    std::map<std::string, std::string> params;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t eq = line.find('=');
+        const std::string key = trim(line.substr(0, eq));
+        if (key.empty() || key[0] == '#') continue;
+        params[key] = (eq == std::string::npos) ? "" : trim(line.substr(eq + 1));
+    }
+
+    std::vector<std::string> unknown;
+    for (const auto& [key, value] : params) {
+        auto flag = PARAM_FLAGS.find(key);
+        if (flag == PARAM_FLAGS.end()) {
+            unknown.push_back(key);
+            continue;
+        }
+        args.push_back(flag->second);
+        args.push_back(value);
+    }
+    if (!unknown.empty()) {
+        std::cerr << "[AVISO] " << path << ": se ignoraron " << unknown.size()
+                  << " clave(s) no mapeadas:";
+        for (const auto& k : unknown) std::cerr << " " << k;
+        std::cerr << "\n";
+    }
+    return true;
+}
+
+// =========================================================
+// CONJUNTOS DEL BARRIDO
+// =========================================================
+
+bool loadParameterSweep(const std::string& source, std::vector<SweepSet>& sets) {
+    std::vector<std::string> files;
+    if (!listParameterFiles(source, files)) return false;
+    if (files.empty()) {
+        std::cerr << "Error: --sweep " << source << " no tiene archivos de parámetros.\n";
+        return false;
+    }
+
+    const SimulationConfig base = captureConfig();
+    const int baseFirstIndex = CURRENT_SIMULATION;
+    std::map<std::string, std::string> directories;   // directorio de salida -> archivo
+    bool ok = true;
+
+    for (const auto& file : files) {
+        applyConfig(base);
+        CURRENT_SIMULATION = baseFirstIndex;
+
+        std::vector<std::string> args = {"silo_simulator"};
+        if (!readParameterFile(file, args)) { ok = false; break; }
+        std::vector<char*> argv;
+        for (auto& a : args) argv.push_back(a.data());
+
+        if (!parseAndValidateArgs((int)argv.size(), argv.data())) {
+            std::cerr << "Error: parámetros inválidos en " << file << "\n";
+            ok = false;
+            break;
+        }
+        if (FORK_DISCHARGES) {
+            std::cerr << "Error: " << file << ": FORK_DISCHARGES no se admite con --sweep.\n";
+            ok = false;
+            break;
+        }
+        calculateDerivedParameters();
+        if (RANDOM_SEED < 0) RANDOM_SEED = base.RANDOM_SEED;
+
+        SweepSet set;
+        set.source = file;
+        set.firstIndex = CURRENT_SIMULATION;
+        set.count = std::max(0, TOTAL_SIMULATIONS);
+        set.config = captureConfig();
+
+        // Dos tareas en el mismo directorio se pisarían los archivos
+        for (int k = 0; k < set.count && ok; ++k) {
+            CURRENT_SIMULATION = set.firstIndex + k;
+            auto [it, inserted] = directories.emplace(replicaOutputDirectory(), file);
+            if (!inserted) {
+                std::cerr << "Error: " << file << " y " << it->second
+                          << " escriben en el mismo directorio " << it->first
+                          << " (revisar CURRENT_SIM/TOTAL_SIMS).\n";
+                ok = false;
+            }
+        }
+        if (!ok) break;
+        sets.push_back(set);
+    }
+
+    applyConfig(base);
+    CURRENT_SIMULATION = baseFirstIndex;
+    return ok;
+}
+
+int sweepWorkerCount(const std::vector<SweepSet>& sets) {
+    if (PARALLEL_REPLICAS > 1) return PARALLEL_REPLICAS;
+    int threadsPerReplica = std::max(1, NUM_THREADS);
+    for (const SweepSet& set : sets) {
+        threadsPerReplica = std::max(threadsPerReplica, set.config.NUM_THREADS);
+    }
+    const int cores = std::max(1, (int)std::thread::hardware_concurrency());
+    return std::max(1, cores / threadsPerReplica);
+}
+
+// =========================================================
+// EJECUCIÓN
+// =========================================================
+
+void runParameterSweep(const std::vector<SweepSet>& sets, int workers,
+                       const std::function<void(SimulationContext&)>& body)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<SweepTask> tasks;
+    for (int s = 0; s < (int)sets.size(); ++s) {
+        for (int k = 0; k < sets[s].count; ++k) tasks.push_back({s, sets[s].firstIndex + k});
+    }
+    const int total = (int)tasks.size();
+    const int numThreads = std::min(std::max(1, workers), std::max(1, total));
+
+    // Reparto en ronda; cada cola se llena al revés para que su dueño siga el orden del barrido
+    std::vector<std::unique_ptr<SweepQueue>> queues;
+    for (int t = 0; t < numThreads; ++t) queues.push_back(std::make_unique<SweepQueue>());
+    for (int i = 0; i < total; ++i) queues[i % numThreads]->tasks.push_front(tasks[i]);
+
+    std::cout << "=== BARRIDO: " << sets.size() << " conjuntos, " << total
+              << " tareas en " << numThreads << " hilos ===\n";
+
+    std::mutex printMutex;
+    std::atomic<int> done{0};
+    std::atomic<int> steals{0};
+    const auto start = Clock::now();
+
+    auto worker = [&](int self) {
+        SweepTask task;
+        bool stolen = false;
+        while (popOrSteal(queues, self, task, stolen)) {
+            if (stolen) ++steals;
+            const SweepSet& set = sets[task.set];
+            applyConfig(set.config);
+
+            const auto taskStart = Clock::now();
+            runSingleReplica(task.replica, body);
+            const double taskWall = std::chrono::duration<double>(Clock::now() - taskStart).count();
+            const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+            const int finished = ++done;
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << "[barrido " << finished << "/" << total << "] "
+                      << fs::path(set.source).filename().string() << " réplica " << task.replica
+                      << ": " << std::fixed << std::setprecision(1) << taskWall << " s (hilo " << self
+                      << (stolen ? ", robada" : "") << "); transcurrido " << wall << " s\n";
+        }
+    };
+
+    if (numThreads <= 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+        for (int t = 0; t < numThreads; ++t) threads.emplace_back(worker, t);
+        for (auto& th : threads) th.join();
+    }
+
+    const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "=== FIN DEL BARRIDO: " << done.load() << " tareas en " << std::fixed
+              << std::setprecision(1) << wall << " s (" << steals.load() << " robadas) ===\n";
+}
@@ -0,0 +1,221 @@
+// src/PlacementGrid.cpp
+
+#include "PlacementGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float SAT_EPS = 1e-5f;     // superposición tolerada en la prueba de polígonos
+
+inline bool polygonCircleOverlap(const float* vx, const float* vy, const float* nx, const float* ny,
+                                 int n, float cx, float cy, float r)
+{
+    // Arista de máxima separación; si alguna separa más que r, no hay contacto
+    int best = 0;
+    float bestSep = -1e30f;
+    for (int i = 0; i < n; ++i) {
+        const float s = nx[i] * (cx - vx[i]) + ny[i] * (cy - vy[i]);
+        if (s > r) return false;
+        if (s > bestSep) { bestSep = s; best = i; }
+    }
+    if (bestSep <= 0.0f) return true;   // centro dentro del polígono
+
+    // Región de Voronoi: vértice v1, vértice v2 o la cara
+    const int j = (best + 1 == n) ? 0 : best + 1;
+    const float ex = vx[j] - vx[best], ey = vy[j] - vy[best];
+    const float d1x = cx - vx[best], d1y = cy - vy[best];
+    const float d2x = cx - vx[j],    d2y = cy - vy[j];
+    if (d1x * ex + d1y * ey <= 0.0f) return d1x * d1x + d1y * d1y < r * r;
+    if (-(d2x * ex + d2y * ey) <= 0.0f) return d2x * d2x + d2y * d2y < r * r;
+    return bestSep < r;
+}
+
+// true si alguna normal de A separa a B de A
+inline bool separatedByAxesOf(const float* avx, const float* avy, const float* anx, const float* any,
+                              int an, const float* bvx, const float* bvy, int bn)
+{
+    for (int i = 0; i < an; ++i) {
+        float minProj = 1e30f;
+        for (int k = 0; k < bn; ++k) {
+            const float p = anx[i] * (bvx[k] - avx[i]) + any[i] * (bvy[k] - avy[i]);
+            minProj = std::min(minProj, p);
+        }
+        if (minProj >= -SAT_EPS) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// =========================================================
+// CONFIGURACIÓN
+// =========================================================
+
+void PlacementGrid::reset(float minX, float minY, float maxX, float maxY, float cellSize) {
+    cellSize_ = std::max(cellSize, 1e-6f);
+    invCell_ = 1.0f / cellSize_;
+    minX_ = minX;
+    minY_ = minY;
+    nx_ = std::max(1, (int)std::ceil((maxX - minX) * invCell_));
+    ny_ = std::max(1, (int)std::ceil((maxY - minY) * invCell_));
+    clear();
+}
+
+void PlacementGrid::clear() {
+    px_.clear(); py_.clear(); pr_.clear();
+    sides_.clear(); vertStart_.clear();
+    vx_.clear(); vy_.clear(); nxv_.clear(); nyv_.clear();
+    cellItems_.clear(); itemCell_.clear(); next_.clear();
+    cellStart_.assign((size_t)nx_ * ny_ + 1, 0);
+    head_.assign((size_t)nx_ * ny_, -1);
+    built_ = 0;
+}
+
+int PlacementGrid::cellIndex(float x, float y) const {
+    const int cx = std::min(nx_ - 1, std::max(0, (int)std::floor((x - minX_) * invCell_)));
+    const int cy = std::min(ny_ - 1, std::max(0, (int)std::floor((y - minY_) * invCell_)));
+    return cy * nx_ + cx;
+}
+
+// =========================================================
+// FORMAS
+// =========================================================
+
+const float* PlacementGrid::unitPolygon(int sides) const {
+    if ((int)unitPolys_.size() <= sides) unitPolys_.resize(sides + 1);
+    std::vector<float>& t = unitPolys_[sides];
+    if (t.empty()) {
+        // [cos vértice | sin vértice | cos normal | sin normal]
+        t.resize(4 * sides);
+        for (int j = 0; j < sides; ++j) {
+            const double a = 2.0 * M_PI * j / sides;
+            const double an = a + M_PI / sides;
+            t[j]             = (float)std::cos(a);
+            t[sides + j]     = (float)std::sin(a);
+            t[2 * sides + j] = (float)std::cos(an);
+            t[3 * sides + j] = (float)std::sin(an);
+        }
+    }
+    return t.data();
+}
+
+void PlacementGrid::transform(float x, float y, float cosA, float sinA, float radius, int sides,
+                              float* vx, float* vy, float* nx, float* ny) const
+{
+    const float* t = unitPolygon(sides);
+    const float* cv = t;
+    const float* sv = t + sides;
+    const float* cn = t + 2 * sides;
+    const float* sn = t + 3 * sides;
+    for (int j = 0; j < sides; ++j) {
+        vx[j] = x + radius * (cosA * cv[j] - sinA * sv[j]);
+        vy[j] = y + radius * (sinA * cv[j] + cosA * sv[j]);
+        nx[j] = cosA * cn[j] - sinA * sn[j];
+        ny[j] = sinA * cn[j] + cosA * sn[j];
+    }
+}
+
+void PlacementGrid::append(float x, float y, float cosA, float sinA, float radius, int sides) {
+    px_.push_back(x);
+    py_.push_back(y);
+    pr_.push_back(radius);
+    sides_.push_back(sides);
+    vertStart_.push_back((int)vx_.size());
+    if (sides > 0) {
+        const size_t v = vx_.size();
+        vx_.resize(v + sides); vy_.resize(v + sides);
+        nxv_.resize(v + sides); nyv_.resize(v + sides);
+        transform(x, y, cosA, sinA, radius, sides, &vx_[v], &vy_[v], &nxv_[v], &nyv_[v]);
+    }
+}
+
+PlacementGrid::Shape PlacementGrid::shapeOf(int item) const {
+    const int v = vertStart_[item];
+    const bool poly = sides_[item] > 0;
+    return {px_[item], py_[item], pr_[item], sides_[item],
+            poly ? &vx_[v] : nullptr, poly ? &vy_[v] : nullptr,
+            poly ? &nxv_[v] : nullptr, poly ? &nyv_[v] : nullptr};
+}
+
+bool PlacementGrid::overlapShapes(const Shape& a, const Shape& b) {
+    // Círculos envolventes (el tamaño de los polígonos es el circunradio)
+    const float dx = b.x - a.x, dy = b.y - a.y;
+    const float rs = a.radius + b.radius;
+    if (dx * dx + dy * dy >= rs * rs) return false;
+
+    if (a.sides == 0 && b.sides == 0) return true;
+    if (a.sides == 0) return polygonCircleOverlap(b.vx, b.vy, b.nx, b.ny, b.sides, a.x, a.y, a.radius);
+    if (b.sides == 0) return polygonCircleOverlap(a.vx, a.vy, a.nx, a.ny, a.sides, b.x, b.y, b.radius);
+
+    return !separatedByAxesOf(a.vx, a.vy, a.nx, a.ny, a.sides, b.vx, b.vy, b.sides) &&
+           !separatedByAxesOf(b.vx, b.vy, b.nx, b.ny, b.sides, a.vx, a.vy, a.sides);
+}
+
+// =========================================================
+// CARGA
+// =========================================================
+
+void PlacementGrid::stage(float x, float y, float cosA, float sinA, float radius, int sides) {
+    append(x, y, cosA, sinA, radius, sides);
+}
+
+void PlacementGrid::build() {
+    const size_t n = px_.size();
+    const size_t cells = (size_t)nx_ * ny_;
+
+    // Counting sort por celda: histograma, suma prefija y dispersión
+    cellStart_.assign(cells + 1, 0);
+    itemCell_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        itemCell_[i] = cellIndex(px_[i], py_[i]);
+        ++cellStart_[itemCell_[i] + 1];
+    }
+    for (size_t c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+
+    cellItems_.resize(n);
+    head_.assign(cellStart_.begin(), cellStart_.end() - 1);   // cursor de escritura por celda
+    for (size_t i = 0; i < n; ++i) cellItems_[head_[itemCell_[i]]++] = (int)i;
+
+    head_.assign(cells, -1);
+    next_.assign(n, -1);
+    built_ = n;
+}
+
+void PlacementGrid::add(float x, float y, float cosA, float sinA, float radius, int sides) {
+    const int item = (int)px_.size();
+    append(x, y, cosA, sinA, radius, sides);
+    const int c = cellIndex(x, y);
+    next_.push_back(head_[c]);
+    head_[c] = item;
+}
+
+// =========================================================
+// CONSULTA
+// =========================================================
+
+bool PlacementGrid::overlaps(float x, float y, float cosA, float sinA, float radius, int sides) const {
+    // Candidata en buffers de pila (sides <= 8 en la práctica; más lados se prueban como círculo)
+    const int MAX_SIDES = 16;
+    float vx[MAX_SIDES], vy[MAX_SIDES], nx[MAX_SIDES], ny[MAX_SIDES];
+    Shape cand = {x, y, radius, 0, nullptr, nullptr, nullptr, nullptr};
+    if (sides > 0 && sides <= MAX_SIDES) {
+        transform(x, y, cosA, sinA, radius, sides, vx, vy, nx, ny);
+        cand = {x, y, radius, sides, vx, vy, nx, ny};
+    }
+
+    const int c = cellIndex(x, y);
+    const int cx = c % nx_, cy = c / nx_;
+    for (int yy = std::max(0, cy - 1); yy <= std::min(ny_ - 1, cy + 1); ++yy) {
+        for (int xx = std::max(0, cx - 1); xx <= std::min(nx_ - 1, cx + 1); ++xx) {
+            const int cell = yy * nx_ + xx;
+            for (int k = cellStart_[cell]; k < cellStart_[cell + 1]; ++k) {
+                if (overlapShapes(cand, shapeOf(cellItems_[k]))) return true;
+            }
+            for (int item = head_[cell]; item >= 0; item = next_[item]) {
+                if (overlapShapes(cand, shapeOf(item))) return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,93 @@
+// src/RandomStreams.cpp
+
+#include "RandomStreams.h"
+
+namespace {
+
+const uint32_t PHILOX_M0 = 0xD2511F53u;
+const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+const uint32_t PHILOX_W0 = 0x9E3779B9u;
+const uint32_t PHILOX_W1 = 0xBB67AE85u;
+const int      PHILOX_ROUNDS = 10;
+
+inline void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+    const uint64_t p = (uint64_t)a * b;
+    hi = (uint32_t)(p >> 32);
+    lo = (uint32_t)p;
+}
+
+thread_local RandomStream replicaStreams[RNG_SUBSYSTEMS];
+
+} // namespace
+
+// =========================================================
+// PHILOX4x32-10
+// =========================================================
+
+void philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int r = 0; r < PHILOX_ROUNDS; ++r) {
+        uint32_t hi0, lo0, hi1, lo1;
+        mulhilo(PHILOX_M0, c0, hi0, lo0);
+        mulhilo(PHILOX_M1, c2, hi1, lo1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+// =========================================================
+// FLUJO
+// =========================================================
+
+void RandomStream::seed(uint64_t seed, uint32_t replica, uint32_t subsystem) {
+    key_[0] = (uint32_t)seed;
+    key_[1] = (uint32_t)(seed >> 32);
+    stream_[0] = replica;
+    stream_[1] = subsystem;
+    block_ = 0;
+    pos_ = BUFFER_WORDS;
+}
+
+void RandomStream::refill() {
+    for (size_t b = 0; b < BATCH_BLOCKS; ++b) {
+        const uint64_t n = block_ + b;
+        const uint32_t counter[4] = {(uint32_t)n, (uint32_t)(n >> 32), stream_[0], stream_[1]};
+        philox4x32(counter, key_, buffer_ + 4 * b);
+    }
+    block_ += BATCH_BLOCKS;
+    pos_ = 0;
+}
+
+void RandomStream::uniforms(float* out, size_t n, float a, float b) {
+    const float scale = (b - a) * (1.0f / 16777216.0f);
+    size_t i = 0;
+    while (i < n) {
+        if (pos_ == BUFFER_WORDS) refill();
+        const size_t take = (n - i < BUFFER_WORDS - pos_) ? n - i : BUFFER_WORDS - pos_;
+        for (size_t j = 0; j < take; ++j) {
+            out[i + j] = a + (float)(buffer_[pos_ + j] >> 8) * scale;
+        }
+        pos_ += take;
+        i += take;
+    }
+}
+
+// =========================================================
+// FLUJOS DE LA RÉPLICA EN CURSO
+// =========================================================
+
+RandomStream& rng(RngSubsystem subsystem) {
+    return replicaStreams[subsystem];
+}
+
+void seedReplicaStreams(uint64_t seed, uint32_t replica) {
+    for (uint32_t s = 0; s < RNG_SUBSYSTEMS; ++s) {
+        replicaStreams[s].seed(seed, replica, s);
+    }
+}
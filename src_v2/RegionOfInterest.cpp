@@ -0,0 +1,129 @@
+// src/RegionOfInterest.cpp
+
+#include "RegionOfInterest.h"
+#include "StateSnapshot.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float ROI_CHECK_INTERVAL = 0.05f;   // s entre chequeos
+const float ROI_FREEZE_SPEED   = 0.02f;   // velocidad máx. para recongelar
+const int   ROI_FREEZE_CHECKS  = 4;       // chequeos lentos seguidos para recongelar
+
+} // namespace
+
+// =========================================================
+// CONGELAR / DESCONGELAR
+// =========================================================
+
+void RoiController::freeze(int i, const std::vector<ParticleInfo>& particles) {
+    const b2BodyId body = particles[i].bodyId;
+    b2Body_SetType(body, b2_kinematicBody);
+    b2Body_SetLinearVelocity(body, {0.0f, 0.0f});
+    b2Body_SetAngularVelocity(body, 0.0f);
+    frozen_[i] = 1;
+    slowChecks_[i] = 0;
+    ++frozenCount_;
+    ++freezeCount_;
+}
+
+void RoiController::thaw(int i, const std::vector<ParticleInfo>& particles) {
+    const b2BodyId body = particles[i].bodyId;
+    b2Body_SetType(body, b2_dynamicBody);
+    b2Body_SetAwake(body, true);
+    frozen_[i] = 0;
+    slowChecks_[i] = 0;
+    --frozenCount_;
+    ++thawCount_;
+}
+
+int RoiController::column(float x) const {
+    return std::min(columns_ - 1, std::max(0, (int)std::floor((x - minX_) / layer_)));
+}
+
+// =========================================================
+// INICIALIZACIÓN
+// =========================================================
+
+void RoiController::reset(const std::vector<ParticleInfo>& particles) {
+    radius_ = BASE_RADIUS;
+    for (const auto& p : particles) radius_ = std::max(radius_, p.size);
+
+    roiTop_   = GROUND_LEVEL_Y + ROI_HEIGHT * OUTLET_WIDTH;
+    layer_    = 4.0f * radius_;
+    minX_     = -0.5f * SILO_WIDTH;
+    columns_  = std::max(1, (int)std::ceil(SILO_WIDTH / layer_));
+    lastCheck_ = 0.0f;
+
+    frozen_.assign(particles.size(), 0);
+    slowChecks_.assign(particles.size(), 0);
+    frozenBottom_.resize(columns_);
+    activeTop_.resize(columns_);
+    frozenCount_ = 0;
+    thawCount_ = freezeCount_ = 0;
+
+    const StateSnapshot& S = stateSnapshot;
+    for (size_t i = 0; i < particles.size() && i < S.size(); ++i) {
+        if (S.y[i] > roiTop_) freeze((int)i, particles);
+    }
+    freezeCount_ = 0;   // sólo cuentan los recongelamientos
+}
+
+// =========================================================
+// ACTUALIZACIÓN
+// =========================================================
+
+void RoiController::update(float time, const std::vector<ParticleInfo>& particles) {
+    if (time - lastCheck_ < ROI_CHECK_INTERVAL) return;
+    lastCheck_ = time;
+
+    StateSnapshot& S = stateSnapshot;
+    S.refreshVelocities(particles);
+    const int n = (int)std::min(particles.size(), S.size());
+
+    // Base congelada de cada columna y tope dinámico por debajo de ella
+    std::fill(frozenBottom_.begin(), frozenBottom_.end(), 1e30f);
+    std::fill(activeTop_.begin(), activeTop_.end(), GROUND_LEVEL_Y);
+    for (int i = 0; i < n; ++i) {
+        if (frozen_[i]) {
+            float& b = frozenBottom_[column(S.x[i])];
+            b = std::min(b, S.y[i]);
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        if (!frozen_[i]) {
+            const int c = column(S.x[i]);
+            if (S.y[i] < frozenBottom_[c]) activeTop_[c] = std::max(activeTop_[c], S.y[i]);
+        }
+    }
+
+    // Descongelar la capa inferior de las columnas con hueco
+    const float maxGap = 3.0f * radius_;
+    if (frozenCount_ > 0) {
+        for (int i = 0; i < n; ++i) {
+            if (!frozen_[i]) continue;
+            const int c = column(S.x[i]);
+            if (frozenBottom_[c] - activeTop_[c] > maxGap && S.y[i] < frozenBottom_[c] + layer_) {
+                thaw(i, particles);
+            }
+        }
+    }
+
+    // Recongelar lo que quedó quieto por encima de la región de interés
+    const float refreezeY = roiTop_ + layer_;
+    const float vSlow2 = ROI_FREEZE_SPEED * ROI_FREEZE_SPEED;
+    for (int i = 0; i < n; ++i) {
+        if (frozen_[i] || S.y[i] <= refreezeY) { slowChecks_[i] = 0; continue; }
+        const float v2 = S.vx[i]*S.vx[i] + S.vy[i]*S.vy[i];
+        if (v2 >= vSlow2) { slowChecks_[i] = 0; continue; }
+        if (++slowChecks_[i] >= ROI_FREEZE_CHECKS) freeze(i, particles);
+    }
+}
+
+bool RoiController::quiescent() const {
+    for (int i : stateSnapshot.awakeList) {
+        if (i < (int)frozen_.size() && !frozen_[i]) return false;
+    }
+    return true;
+}
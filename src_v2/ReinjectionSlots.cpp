@@ -0,0 +1,111 @@
+// src/ReinjectionSlots.cpp
+
+#include "ReinjectionSlots.h"
+#include "Constants.h"
+#include "StateSnapshot.h"
+#include "RandomStreams.h"
+#include <algorithm>
+#include <cmath>
+
+thread_local ReinjectionSlots reinjectionSlots;
+
+namespace {
+
+const float SLOT_SPACING = 2.1f;     // separación de lugares / radio máximo
+
+} // namespace
+
+// =========================================================
+// RED DE LUGARES
+// =========================================================
+
+void ReinjectionSlots::buildLattice(float siloHeight) {
+    radius_ = BASE_RADIUS;
+    for (const auto& p : particles) radius_ = std::max(radius_, p.size);
+
+    const float halfW = SILO_WIDTH * REINJECT_WIDTH_RATIO * 0.5f;
+    minX_ = -halfW;
+    maxX_ =  halfW;
+    minY_ = siloHeight * REINJECT_HEIGHT_RATIO;
+    maxY_ = siloHeight * (REINJECT_HEIGHT_RATIO + REINJECT_HEIGHT_VARIATION);
+
+    // Red triangular con centros a >= radio de los bordes de la banda
+    const float dx = SLOT_SPACING * radius_;
+    const float dy = dx * 0.8660254f;
+    slots_.clear();
+    int row = 0;
+    for (float y = minY_ + radius_; y <= maxY_ - radius_ + 1e-6f; y += dy, ++row) {
+        const float offset = (row % 2) ? 0.5f * dx : 0.0f;
+        for (float x = minX_ + radius_ + offset; x <= maxX_ - radius_ + 1e-6f; x += dx) {
+            slots_.push_back({x, y});
+        }
+    }
+    // Banda más angosta que una partícula: un único lugar en el centro
+    if (slots_.empty()) slots_.push_back({0.5f * (minX_ + maxX_), 0.5f * (minY_ + maxY_)});
+
+    order_.resize(slots_.size());
+    grid_.reset(minX_ - 2.0f * radius_, minY_ - 2.0f * radius_,
+                maxX_ + 2.0f * radius_, maxY_ + 2.0f * radius_, 2.0f * radius_);
+    siloHeight_ = siloHeight;
+}
+
+void ReinjectionSlots::reset() {
+    siloHeight_ = -1.0f;
+    slots_.clear();
+    fallbacks_ = 0;
+}
+
+// =========================================================
+// TANDA
+// =========================================================
+
+void ReinjectionSlots::place(const std::vector<int>& indices, float siloHeight) {
+    if (indices.empty()) return;
+    if (siloHeight != siloHeight_ || slots_.empty()) buildLattice(siloHeight);
+
+    // Partículas presentes en la banda (las que se reinyectan están bajo el orificio o fuera del silo)
+    StateSnapshot& S = stateSnapshot;
+    const float reach = 2.0f * radius_;
+    grid_.clear();
+    for (size_t k = 0; k < S.size() && k < particles.size(); ++k) {
+        if (S.y[k] < minY_ - reach || S.y[k] > maxY_ + reach) continue;
+        if (S.x[k] < minX_ - reach || S.x[k] > maxX_ + reach) continue;
+        grid_.stage(S.x[k], S.y[k], S.cosA[k], S.sinA[k], particles[k].size, particles[k].numSides);
+    }
+    grid_.build();
+
+    RandomStream& random = rng(RNG_REINJECTION);
+    for (size_t s = 0; s < order_.size(); ++s) order_[s] = (int)s;
+    std::shuffle(order_.begin(), order_.end(), random);
+
+    // Jitter en un disco: con el cuadrado, dos vecinos en diagonal podían quedar a menos de 2R
+    const float jitter = 0.5f * (SLOT_SPACING - 2.0f) * radius_;
+    const b2Rot rotation = {1.0f, 0.0f};
+    const b2Vec2 velocity = {0.0f, -REINJECT_VELOCITY};
+
+    size_t next = 0;
+    for (int i : indices) {
+        const ParticleInfo& p = particles[i];
+        b2Vec2 pos;
+        bool found = false;
+        while (next < order_.size() && !found) {
+            const b2Vec2 slot = slots_[order_[next++]];
+            const float angle = random.uniform(0.0f, 2.0f * float(M_PI));
+            const float r = jitter * std::sqrt(random.uniform());
+            pos = {slot.x + r * std::cos(angle), slot.y + r * std::sin(angle)};
+            found = !grid_.overlaps(pos.x, pos.y, rotation.c, rotation.s, p.size, p.numSides);
+        }
+        if (!found) {
+            pos = {random.uniform(minX_, maxX_), random.uniform(minY_, maxY_)};
+            ++fallbacks_;
+        }
+        // Las siguientes de la tanda también se prueban contra ésta
+        grid_.add(pos.x, pos.y, rotation.c, rotation.s, p.size, p.numSides);
+
+        b2Body_SetTransform(p.bodyId, pos, rotation);
+        S.setPose(i, pos, rotation);
+        b2Body_SetLinearVelocity(p.bodyId, velocity);
+        b2Body_SetAngularVelocity(p.bodyId, 0.0f);
+        b2Body_SetAwake(p.bodyId, true);
+    }
+}
@@ -0,0 +1,81 @@
+// src/SimulationContext.cpp
+
+#include "SimulationContext.h"
+#include "Constants.h"
+#include "Initialization.h"
+#include "DataHandling.h"
+#include "StateSnapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// =========================================================
+// CICLO DE VIDA DE UNA RÉPLICA
+// =========================================================
+
+void beginReplica(SimulationContext& ctx) {
+    requireConfig("beginReplica");
+    resetRunState(ctx.simulationIndex, ctx.seed);
+    particles.clear();
+    stateSnapshot = StateSnapshot();
+    particleBodyIds.clear();
+    worldId = b2_nullWorldId;
+
+    ctx.worldId = b2_nullWorldId;
+    ctx.outletBlockId = b2_nullBodyId;
+    ctx.interrupted = false;
+
+    initializeDataFiles();
+}
+
+void endReplica(SimulationContext& ctx) {
+    finalizeDataFiles(ctx.interrupted);
+
+    if (B2_IS_NON_NULL(ctx.worldId)) {
+        destroyWorld(ctx.worldId);
+    }
+    ctx.worldId = b2_nullWorldId;
+    worldId = b2_nullWorldId;
+    particles.clear();
+    stateSnapshot = StateSnapshot();
+    particleBodyIds.clear();
+}
+
+// =========================================================
+// EJECUCIÓN EN SERIE / EN PARALELO
+// =========================================================
+
+void runSingleReplica(int simulationIndex, const std::function<void(SimulationContext&)>& body) {
+    SimulationContext ctx;
+    ctx.simulationIndex = simulationIndex;
+    ctx.seed = (uint64_t)RANDOM_SEED;   // la réplica usa los flujos (semilla, índice)
+    beginReplica(ctx);
+    body(ctx);
+    endReplica(ctx);
+}
+
+void runReplicas(int firstIndex, int count, int parallel,
+                 const std::function<void(SimulationContext&)>& body)
+{
+    const int numThreads = std::min(std::max(1, parallel), std::max(1, count));
+    if (numThreads <= 1) {
+        for (int k = 0; k < count; ++k) runSingleReplica(firstIndex + k, body);
+        return;
+    }
+
+    // Cola dinámica: cada hilo toma la siguiente réplica libre (los atascos largos no frenan al resto)
+    const SimulationConfig config = captureConfig();
+    std::atomic<int> next{0};
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&] {
+            applyConfig(config);
+            for (int k = next++; k < count; k = next++) {
+                runSingleReplica(firstIndex + k, body);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+}
@@ -0,0 +1,85 @@
+// src/StabilityMonitor.cpp
+
+#include "StabilityMonitor.h"
+#include "StateSnapshot.h"
+#include "Constants.h"
+#include <algorithm>
+#include <cmath>
+
+// =========================================================
+// MUESTRA
+// =========================================================
+
+StabilitySample StabilityMonitor::sample(const std::vector<ParticleInfo>& particles) {
+    StateSnapshot& S = stateSnapshot;
+    S.refreshVelocities(particles);
+
+    const int n = (int)std::min(particles.size(), S.size());
+    const float vSlow2 = criteria_.vSlow * criteria_.vSlow;
+
+    // Sólo despiertos: los dormidos aportan E = 0 y cuentan como lentos
+    float KE = 0.0f;
+    int slowAwake = 0, awakeCount = 0;
+    float yMax = S.sleepingMaxY();
+    for (int i : S.awakeList) {
+        if (i >= n) continue;
+        ++awakeCount;
+        const float v2 = S.vx[i]*S.vx[i] + S.vy[i]*S.vy[i];
+        KE += 0.5f * particles[i].mass * v2;
+        if (v2 < vSlow2 && std::fabs(S.w[i]) < criteria_.wSlow) ++slowAwake;
+        yMax = std::max(yMax, S.y[i]);
+    }
+
+    StabilitySample s;
+    s.kineticEnergy = KE;
+    s.kePerParticle = (n > 0) ? KE / n : 0.0f;
+    s.keDelta       = std::fabs(KE - prevKE_);
+    s.slowFraction  = (n > 0) ? float(n - awakeCount + slowAwake) / n : 1.0f;
+    s.yMax          = yMax;
+    s.awakeCount    = awakeCount;
+    s.quiescent     = (awakeCount == 0);
+
+    const bool bandClear = (yMax <= criteria_.yCeiling);
+    if (s.quiescent) {
+        s.stable = bandClear;
+    } else {
+        s.stable = s.kePerParticle < criteria_.kePerParticle &&
+                   (criteria_.keDelta < 0.0f || s.keDelta < criteria_.keDelta) &&
+                   s.slowFraction >= criteria_.slowFraction &&
+                   bandClear;
+    }
+    prevKE_ = KE;
+    return s;
+}
+
+// =========================================================
+// CRITERIOS
+// =========================================================
+
+StabilityCriteria sedimentationCriteria() {
+    float Rmax = BASE_RADIUS;
+    if (SIZE_RATIO > 0.f) Rmax = std::max(Rmax, BASE_RADIUS * SIZE_RATIO);
+    if (NUM_POLYGON_PARTICLES > 0 && NUM_SIDES >= 3) {
+        float ns = std::max(3, NUM_SIDES);
+        float polyR = POLYGON_PERIMETER / (2.0f * ns * std::sin(float(M_PI)/ns));
+        Rmax = std::max(Rmax, polyR);
+    }
+    const float pad     = Rmax + 0.01f;
+    const float bandTop = GROUND_LEVEL_Y + silo_height - pad;
+
+    StabilityCriteria criteria;
+    criteria.yCeiling = bandTop - 2.0f * Rmax;
+    return criteria;
+}
+
+// =========================================================
+// SEÑALES BARATAS
+// =========================================================
+
+bool particlesQuiescent() {
+    return stateSnapshot.awakeList.empty();
+}
+
+bool worldQuiescent(b2WorldId worldId) {
+    return b2World_GetAwakeBodyCount(worldId) == 0;
+}
@@ -0,0 +1,119 @@
+// src/StateSnapshot.cpp
+
+#include "StateSnapshot.h"
+#include <algorithm>
+#include <cmath>
+
+thread_local StateSnapshot stateSnapshot;
+
+// =========================================================
+// LECTURAS
+// =========================================================
+
+float StateSnapshot::angle(size_t i) const {
+    return std::atan2(sinA[i], cosA[i]);
+}
+
+void StateSnapshot::captureAll(const std::vector<ParticleInfo>& particles) {
+    const size_t n = particles.size();
+    x.resize(n); y.resize(n);
+    cosA.resize(n); sinA.resize(n);
+    vx.resize(n); vy.resize(n); w.resize(n);
+    awake.resize(n);
+    awakeList.clear();
+
+    for (size_t i = 0; i < n; ++i) {
+        const b2BodyId id = particles[i].bodyId;
+        b2Transform xf = b2Body_GetTransform(id);
+        b2Vec2 v = b2Body_GetLinearVelocity(id);
+        x[i] = xf.p.x;     y[i] = xf.p.y;
+        cosA[i] = xf.q.c;  sinA[i] = xf.q.s;
+        vx[i] = v.x;       vy[i] = v.y;
+        w[i] = b2Body_GetAngularVelocity(id);
+        awake[i] = b2Body_IsAwake(id) ? 1 : 0;
+        if (awake[i]) awakeList.push_back((int)i);
+    }
+    velocitiesFresh_ = true;
+    sleepingMaxDirty_ = true;
+}
+
+void StateSnapshot::markAsleep(int i) {
+    awake[i] = 0;
+    vx[i] = vy[i] = w[i] = 0.0f;
+    if (!sleepingMaxDirty_) sleepingMaxY_ = std::max(sleepingMaxY_, y[i]);
+}
+
+void StateSnapshot::markAwake(int i) {
+    // Si se despierta el dormido más alto, el máximo se recalcula a pedido
+    if (awake[i] == 0 && y[i] >= sleepingMaxY_) sleepingMaxDirty_ = true;
+    awake[i] = 1;
+    awakeList.push_back(i);
+}
+
+void StateSnapshot::applyMoveEvents(b2WorldId worldId) {
+    b2BodyEvents events = b2World_GetBodyEvents(worldId);
+    const int n = (int)x.size();
+
+    // Despiertos del paso anterior: los que no reciban evento en éste dejaron de moverse
+    prevAwake_.swap(awakeList);
+    awakeList.clear();
+    for (int i : prevAwake_) awake[i] = 2;
+
+    for (int e = 0; e < events.moveCount; ++e) {
+        const b2BodyMoveEvent& ev = events.moveEvents[e];
+        const int i = static_cast<int>(reinterpret_cast<intptr_t>(ev.userData)) - 1;
+        if (i < 0 || i >= n) continue;   // cuerpo ajeno a particles (o aún no capturado)
+
+        if (!ev.fellAsleep) markAwake(i);
+        x[i] = ev.transform.p.x;     y[i] = ev.transform.p.y;
+        cosA[i] = ev.transform.q.c;  sinA[i] = ev.transform.q.s;
+        if (ev.fellAsleep) markAsleep(i);
+    }
+
+    for (int i : prevAwake_) {
+        if (awake[i] == 2) markAsleep(i);
+    }
+    velocitiesFresh_ = false;
+}
+
+void StateSnapshot::refreshVelocities(const std::vector<ParticleInfo>& particles) {
+    if (velocitiesFresh_) return;
+
+    // Sólo los despiertos: los dormidos ya tienen velocidad nula
+    for (int i : awakeList) {
+        if (i >= (int)particles.size()) continue;
+        const b2BodyId id = particles[i].bodyId;
+        b2Vec2 v = b2Body_GetLinearVelocity(id);
+        vx[i] = v.x; vy[i] = v.y;
+        w[i] = b2Body_GetAngularVelocity(id);
+    }
+    velocitiesFresh_ = true;
+}
+
+void StateSnapshot::setPose(int i, b2Vec2 pos, b2Rot rot) {
+    if (i < 0 || i >= (int)x.size()) return;
+    if (awake[i] != 1) markAwake(i);
+    x[i] = pos.x;     y[i] = pos.y;
+    cosA[i] = rot.c;  sinA[i] = rot.s;
+    vx[i] = vy[i] = w[i] = 0.0f;
+}
+
+float StateSnapshot::sleepingMaxY() {
+    if (sleepingMaxDirty_) {
+        sleepingMaxY_ = -1e30f;
+        for (size_t i = 0; i < y.size(); ++i) {
+            if (!awake[i]) sleepingMaxY_ = std::max(sleepingMaxY_, y[i]);
+        }
+        sleepingMaxDirty_ = false;
+    }
+    return sleepingMaxY_;
+}
+
+// =========================================================
+// PASO DEL MUNDO
+// =========================================================
+
+void stepWorld(b2WorldId worldId, float dt, int subSteps) {
+    b2World_Step(worldId, dt, subSteps);
+    stateSnapshot.applyMoveEvents(worldId);
+}
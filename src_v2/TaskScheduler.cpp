@@ -0,0 +1,200 @@
+// src/TaskScheduler.cpp
+
+#include "TaskScheduler.h"
+#include "Constants.h"
+#include <algorithm>
+#include <memory>
+
+// =========================================================
+// CONSTRUCCIÓN / DESTRUCCIÓN DEL POOL
+// =========================================================
+
+TaskScheduler::TaskScheduler(int workerCount)
+    : workerCount_(std::max(1, workerCount))
+{
+    queues_.reserve(workerCount_);
+    for (int i = 0; i < workerCount_; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    // El worker 0 es el hilo que llama a b2World_Step; se lanzan los restantes
+    for (int i = 1; i < workerCount_; ++i) {
+        threads_.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    sleepCondition_.notify_all();
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void TaskScheduler::configureWorldDef(b2WorldDef& worldDef) {
+    if (workerCount_ <= 1) return;
+
+    worldDef.workerCount = workerCount_;
+    worldDef.enqueueTask = &TaskScheduler::enqueueTask;
+    worldDef.finishTask = &TaskScheduler::finishTask;
+    worldDef.userTaskContext = this;
+}
+
+// =========================================================
+// CALLBACKS DE BOX2D
+// =========================================================
+
+void* TaskScheduler::enqueueTask(b2TaskCallback* task, int itemCount, int minRange,
+                                 void* taskContext, void* userContext)
+{
+    TaskScheduler* self = static_cast<TaskScheduler*>(userContext);
+
+    // Bloques de al menos minRange ítems, con sobre-partición x4 para que el robo equilibre.
+    // Aun con un solo bloque la tarea va a las colas: las b2SolverTask (un ítem cada una)
+    // tienen que correr en paralelo en hilos distintos
+    int chunks = itemCount / std::max(1, minRange);
+    chunks = std::min(std::max(chunks, 1), 4 * self->workerCount_);
+
+    // Sin grupos libres: se ejecuta en serie y Box2D no llama a finishTask
+    if (itemCount <= 0 || self->taskCount_ >= MAX_TASKS) {
+        if (itemCount > 0) task(0, itemCount, 0, taskContext);
+        return nullptr;
+    }
+
+    TaskGroup* group = &self->groups_[self->taskCount_++];
+    group->task = task;
+    group->taskContext = taskContext;
+    group->remaining.store(chunks, std::memory_order_relaxed);
+    ++self->outstandingTasks_;
+
+    const int baseSize = itemCount / chunks;
+    const int extra    = itemCount % chunks;
+    const int firstQueue = self->nextQueue_;
+    self->nextQueue_ = (self->nextQueue_ + 1) % self->workerCount_;
+    int start = 0;
+    for (int c = 0; c < chunks; ++c) {
+        int end = start + baseSize + (c < extra ? 1 : 0);
+        WorkerQueue& q = *self->queues_[(firstQueue + c) % self->workerCount_];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.items.push_back({group, start, end});
+        }
+        start = end;
+    }
+
+    self->pendingItems_.fetch_add(chunks, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(self->sleepMutex_);
+    }
+    self->sleepCondition_.notify_all();
+
+    return group;
+}
+
+void TaskScheduler::finishTask(void* userTask, void* userContext) {
+    TaskScheduler* self = static_cast<TaskScheduler*>(userContext);
+    TaskGroup* group = static_cast<TaskGroup*>(userTask);
+
+    // El hilo principal colabora como worker 0 hasta que el grupo termina
+    WorkItem item;
+    while (group->remaining.load(std::memory_order_acquire) > 0) {
+        if (self->popOrSteal(0, item)) {
+            self->execute(item, 0);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    if (--self->outstandingTasks_ == 0) {
+        self->taskCount_ = 0;
+    }
+}
+
+// =========================================================
+// EJECUCIÓN Y ROBO DE TRABAJO
+// =========================================================
+
+bool TaskScheduler::popOrSteal(int workerIndex, WorkItem& out) {
+    // Cola propia: se toma por detrás (lo último encolado, más caliente en caché)
+    {
+        WorkerQueue& own = *queues_[workerIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            out = own.items.back();
+            own.items.pop_back();
+            pendingItems_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Robo: se recorre el resto de las colas y se toma por delante
+    for (int k = 1; k < workerCount_; ++k) {
+        WorkerQueue& victim = *queues_[(workerIndex + k) % workerCount_];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            out = victim.items.front();
+            victim.items.pop_front();
+            pendingItems_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::execute(const WorkItem& item, int workerIndex) {
+    item.group->task(item.start, item.end, static_cast<uint32_t>(workerIndex), item.group->taskContext);
+    queues_[workerIndex]->executed.fetch_add(1, std::memory_order_relaxed);
+    item.group->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+std::vector<long long> TaskScheduler::itemsPerWorker() const {
+    std::vector<long long> counts;
+    counts.reserve(queues_.size());
+    for (const auto& q : queues_) counts.push_back(q->executed.load(std::memory_order_relaxed));
+    return counts;
+}
+
+void TaskScheduler::workerLoop(int workerIndex) {
+    const int SPIN_BEFORE_SLEEP = 256;
+    WorkItem item;
+
+    while (!stop_.load(std::memory_order_acquire)) {
+        if (popOrSteal(workerIndex, item)) {
+            execute(item, workerIndex);
+            continue;
+        }
+
+        // Espera activa corta: entre subpasos llegan tareas nuevas en microsegundos
+        int spins = 0;
+        while (pendingItems_.load(std::memory_order_acquire) == 0 &&
+               !stop_.load(std::memory_order_acquire) && spins++ < SPIN_BEFORE_SLEEP) {
+            std::this_thread::yield();
+        }
+
+        if (pendingItems_.load(std::memory_order_acquire) == 0) {
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepCondition_.wait(lock, [this] {
+                return stop_.load(std::memory_order_acquire) ||
+                       pendingItems_.load(std::memory_order_acquire) > 0;
+            });
+        }
+    }
+}
+
+// =========================================================
+// PLANIFICADOR DEL HILO ACTUAL
+// =========================================================
+
+TaskScheduler& defaultTaskScheduler() {
+    // Uno por hilo: réplicas en paralelo no comparten índices de worker ni grupos de tareas
+    static thread_local std::unique_ptr<TaskScheduler> scheduler;
+    requireConfig("defaultTaskScheduler");
+    if (!scheduler || scheduler->workerCount() != std::max(1, NUM_THREADS)) {
+        scheduler.reset();   // detiene los hilos del anterior antes de crear los nuevos
+        scheduler = std::make_unique<TaskScheduler>(NUM_THREADS);
+    }
+    return *scheduler;
+}
@@ -0,0 +1,256 @@
+// src/TrajectoryCodec.cpp
+
+#include "TrajectoryCodec.h"
+#include <algorithm>
+#include <cmath>
+
+namespace trajectory {
+
+namespace {
+
+const size_t BLOCK_VALUES = 32;   // valores por bloque Rice (un k por bloque)
+const int    K_BITS       = 6;    // bits para guardar k (0..63)
+const int    MAX_K        = 56;
+const uint64_t ESCAPE_Q   = 24;   // cociente unario a partir del cual se escribe el valor crudo
+
+const double TWO_PI = 6.283185307179586;
+const double PI     = 3.141592653589793;
+
+inline uint64_t zigzag(int64_t v)  { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline int64_t  unzigzag(uint64_t u) { return (int64_t)(u >> 1) ^ -(int64_t)(u & 1); }
+
+inline double wrapAngle(double a) {
+    a = std::fmod(a + PI, TWO_PI);
+    if (a <= 0.0) a += TWO_PI;
+    return a - PI;
+}
+
+// ---------------------------------------------------------
+// Flujo de bits (LSB primero)
+// ---------------------------------------------------------
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) { out_.clear(); }
+
+    void put(uint64_t value, int bits) {
+        // bits <= 32 por llamada para que el acumulador de 64 bits no desborde
+        acc_ |= (value & ((1ull << bits) - 1)) << count_;
+        count_ += bits;
+        while (count_ >= 8) {
+            out_.push_back((uint8_t)(acc_ & 0xFF));
+            acc_ >>= 8;
+            count_ -= 8;
+        }
+    }
+    void putOnes(uint64_t n) {
+        while (n >= 32) { put(0xFFFFFFFFull, 32); n -= 32; }
+        if (n) put((1ull << n) - 1, (int)n);
+    }
+    void finish() {
+        if (count_ > 0) out_.push_back((uint8_t)(acc_ & 0xFF));
+        acc_ = 0;
+        count_ = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t acc_ = 0;
+    int count_ = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t bytes) : data_(data), bytes_(bytes) {}
+
+    bool get(int bits, uint64_t& value) {
+        value = 0;
+        for (int got = 0; got < bits; ) {
+            if (count_ == 0) {
+                if (pos_ >= bytes_) return false;
+                acc_ = data_[pos_++];
+                count_ = 8;
+            }
+            int take = std::min(bits - got, count_);
+            value |= (acc_ & ((1ull << take) - 1)) << got;
+            acc_ >>= take;
+            count_ -= take;
+            got += take;
+        }
+        return true;
+    }
+    bool bit(uint64_t& b) { return get(1, b); }
+
+private:
+    const uint8_t* data_;
+    size_t bytes_;
+    size_t pos_ = 0;
+    uint64_t acc_ = 0;
+    int count_ = 0;
+};
+
+// ---------------------------------------------------------
+// Golomb-Rice por bloques
+// ---------------------------------------------------------
+
+void putRaw64(BitWriter& w, uint64_t u) {
+    w.put(u & 0xFFFFFFFFull, 32);
+    w.put(u >> 32, 32);
+}
+
+void encodeRice(BitWriter& w, const std::vector<uint64_t>& values) {
+    for (size_t start = 0; start < values.size(); start += BLOCK_VALUES) {
+        const size_t end = std::min(values.size(), start + BLOCK_VALUES);
+
+        // k ≈ log2(media): minimiza la longitud esperada para residuos ~geométricos
+        long double sum = 0;
+        for (size_t i = start; i < end; ++i) sum += values[i];
+        const long double mean = sum / (long double)(end - start);
+        int k = 0;
+        while (k < MAX_K && (long double)(1ull << (k + 1)) <= mean) ++k;
+        w.put((uint64_t)k, K_BITS);
+
+        for (size_t i = start; i < end; ++i) {
+            const uint64_t u = values[i];
+            const uint64_t q = u >> k;
+            if (q < ESCAPE_Q) {
+                w.putOnes(q);
+                w.put(0, 1);
+                if (k > 32) { w.put(u & 0xFFFFFFFFull, 32); w.put((u >> 32) & ((1ull << (k - 32)) - 1), k - 32); }
+                else if (k > 0) w.put(u & ((1ull << k) - 1), k);
+            } else {
+                // Escape (teletransportes, keyframes atípicos): ESCAPE_Q unos y el valor crudo
+                w.putOnes(ESCAPE_Q);
+                putRaw64(w, u);
+            }
+        }
+    }
+}
+
+bool decodeRice(BitReader& r, std::vector<uint64_t>& values) {
+    for (size_t start = 0; start < values.size(); start += BLOCK_VALUES) {
+        const size_t end = std::min(values.size(), start + BLOCK_VALUES);
+
+        uint64_t k;
+        if (!r.get(K_BITS, k) || k > (uint64_t)MAX_K) return false;
+
+        for (size_t i = start; i < end; ++i) {
+            uint64_t q = 0, b;
+            for (;;) {
+                if (!r.bit(b)) return false;
+                if (!b) break;
+                if (++q == ESCAPE_Q) break;
+            }
+            if (q == ESCAPE_Q) {
+                uint64_t lo, hi;
+                if (!r.get(32, lo) || !r.get(32, hi)) return false;
+                values[i] = lo | (hi << 32);
+                continue;
+            }
+            uint64_t low = 0;
+            if (k > 32) {
+                uint64_t lo, hi;
+                if (!r.get(32, lo) || !r.get((int)k - 32, hi)) return false;
+                low = lo | (hi << 32);
+            } else if (k > 0) {
+                if (!r.get((int)k, low)) return false;
+            }
+            values[i] = (q << k) | low;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// =========================================================
+// CODIFICADOR
+// =========================================================
+
+void Encoder::configure(size_t particleCount, float posQuantum, float angleQuantum) {
+    posQuantum_ = posQuantum;
+    angleQuantum_ = angleQuantum;
+    qx_.assign(particleCount, 0);
+    qy_.assign(particleCount, 0);
+    qa_.assign(particleCount, 0);
+    residuals_.resize(3 * particleCount);
+}
+
+void Encoder::encode(const float* x, const float* y, const float* angle, bool keyframe,
+                     std::vector<uint8_t>& out)
+{
+    const size_t n = qx_.size();
+    uint64_t* rx = residuals_.data();
+    uint64_t* ry = rx + n;
+    uint64_t* ra = ry + n;
+
+    for (size_t i = 0; i < n; ++i) {
+        const int64_t nx = std::llround((double)x[i] / posQuantum_);
+        const int64_t ny = std::llround((double)y[i] / posQuantum_);
+
+        // Ángulo: diferencia envuelta respecto del valor reconstruido, para no saltar 2π
+        int64_t na;
+        if (keyframe) {
+            na = std::llround(wrapAngle(angle[i]) / angleQuantum_);
+        } else {
+            const double prev = (double)qa_[i] * angleQuantum_;
+            na = qa_[i] + std::llround(wrapAngle((double)angle[i] - prev) / angleQuantum_);
+        }
+
+        rx[i] = zigzag(keyframe ? nx : nx - qx_[i]);
+        ry[i] = zigzag(keyframe ? ny : ny - qy_[i]);
+        ra[i] = zigzag(keyframe ? na : na - qa_[i]);
+        qx_[i] = nx;
+        qy_[i] = ny;
+        qa_[i] = na;
+    }
+
+    BitWriter w(out);
+    encodeRice(w, residuals_);
+    w.finish();
+}
+
+// =========================================================
+// DECODIFICADOR
+// =========================================================
+
+void Decoder::configure(size_t particleCount, float posQuantum, float angleQuantum) {
+    posQuantum_ = posQuantum;
+    angleQuantum_ = angleQuantum;
+    qx_.assign(particleCount, 0);
+    qy_.assign(particleCount, 0);
+    qa_.assign(particleCount, 0);
+    residuals_.resize(3 * particleCount);
+    primed_ = false;
+}
+
+bool Decoder::decode(const uint8_t* data, size_t bytes, bool keyframe,
+                     float* x, float* y, float* angle)
+{
+    if (!keyframe && !primed_) return false;
+
+    BitReader r(data, bytes);
+    if (!decodeRice(r, residuals_)) return false;
+
+    const size_t n = qx_.size();
+    const uint64_t* rx = residuals_.data();
+    const uint64_t* ry = rx + n;
+    const uint64_t* ra = ry + n;
+
+    for (size_t i = 0; i < n; ++i) {
+        const int64_t dx = unzigzag(rx[i]);
+        const int64_t dy = unzigzag(ry[i]);
+        const int64_t da = unzigzag(ra[i]);
+        qx_[i] = keyframe ? dx : qx_[i] + dx;
+        qy_[i] = keyframe ? dy : qy_[i] + dy;
+        qa_[i] = keyframe ? da : qa_[i] + da;
+
+        x[i] = (float)((double)qx_[i] * posQuantum_);
+        y[i] = (float)((double)qy_[i] * posQuantum_);
+        angle[i] = (float)wrapAngle((double)qa_[i] * angleQuantum_);
+    }
+    primed_ = true;
+    return true;
+}
+
+} // namespace trajectory
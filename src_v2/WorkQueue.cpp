@@ -0,0 +1,365 @@
+// src/WorkQueue.cpp
+
+#include "WorkQueue.h"
+#include "Constants.h"
+#include "DataHandling.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* STAGING_ROOT = "./simulations/.staging";
+
+struct QueueTask {
+    std::string name;   // <archivo>.sim<k>
+    int set;
+    int replica;
+};
+
+std::string hostName() {
+    char buf[256] = {0};
+    if (gethostname(buf, sizeof(buf) - 1) != 0) return "host";
+    return buf;
+}
+
+// ---------------------------------------------------------
+// Renovación de las reservas del proceso
+// ---------------------------------------------------------
+
+class LeaseKeeper {
+public:
+    explicit LeaseKeeper(float ttl) : period_(std::max(1.0f, ttl * 0.25f)) {
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~LeaseKeeper() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    void add(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_.insert(path);
+    }
+
+    void remove(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_.erase(path);
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            cv_.wait_for(lock, std::chrono::duration<float>(period_), [this] { return stop_; });
+            const auto now = fs::file_time_type::clock::now();
+            for (const auto& path : held_) {
+                std::error_code ec;
+                fs::last_write_time(path, now, ec);
+            }
+        }
+    }
+
+    float period_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::set<std::string> held_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+// ---------------------------------------------------------
+// Cola en disco
+// ---------------------------------------------------------
+
+class DiskQueue {
+public:
+    DiskQueue(const std::string& dir, float ttl)
+        : leases_(fs::path(dir) / "leases"), done_(fs::path(dir) / "done"), ttl_(ttl), keeper_(ttl)
+    {
+        std::ostringstream id;
+        id << hostName() << "." << getpid();
+        owner_ = id.str();
+    }
+
+    bool prepare() {
+        std::error_code ec;
+        fs::create_directories(leases_, ec);
+        if (!ec) fs::create_directories(done_, ec);
+        if (ec) {
+            std::cerr << "Error: no se pudo preparar la cola " << leases_.parent_path().string()
+                      << ": " << ec.message() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& owner() const { return owner_; }
+
+    bool isDone(const QueueTask& task) const {
+        std::error_code ec;
+        return fs::exists(done_ / task.name, ec);
+    }
+
+    // Reserva la tarea (creándola o robando una vencida); false si la tiene otro o ya terminó
+    bool claim(const QueueTask& task) {
+        const fs::path lease = leasePath(task);
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            const int fd = ::open(lease.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+            if (fd >= 0) {
+                std::ostringstream content;
+                content << owner_ << " " << std::chrono::duration_cast<std::chrono::seconds>(
+                               std::chrono::system_clock::now().time_since_epoch()).count() << "\n";
+                const std::string text = content.str();
+                const ssize_t written = ::write(fd, text.data(), text.size());
+                (void)written;
+                ::close(fd);
+                keeper_.add(lease.string());
+
+                // La marca pudo aparecer entre la revisión y la reserva
+                if (isDone(task)) {
+                    release(task);
+                    return false;
+                }
+                return true;
+            }
+            if (errno != EEXIST) {
+                std::cerr << "[cola] No se pudo crear " << lease.string() << ": " << std::strerror(errno) << "\n";
+                return false;
+            }
+            if (attempt > 0 || !expired(lease)) return false;
+
+            // Vencida. Entre la revisión y el rename otro proceso pudo robarla y crear una
+            // reserva nueva en el mismo camino: el rename se lleva lo que haya, así que después
+            // se confirma que sea la misma reserva vencida (mismo contenido, sin renovar)
+            const std::string seen = readFirstLine(lease);
+            const fs::path stale = lease.string() + ".stale." + owner_;
+            std::error_code ec;
+            fs::rename(lease, stale, ec);
+            if (ec) return false;
+            if (readFirstLine(stale) != seen || !expired(stale)) {
+                // Era una reserva viva de otro: se devuelve si el camino sigue libre
+                if (::link(stale.c_str(), lease.c_str()) != 0) {
+                    std::cerr << "[cola] No se pudo devolver la reserva de " << task.name << ": "
+                              << std::strerror(errno) << "\n";
+                }
+                fs::remove(stale, ec);
+                return false;
+            }
+            const std::string staleOwner = firstToken(seen);
+            std::cout << "[cola] Reserva vencida de " << task.name << " (" << seen
+                      << "); se vuelve a tomar\n";
+            fs::remove(stale, ec);
+            if (!staleOwner.empty() && staleOwner != owner_) removeStaging(task, staleOwner);
+        }
+        return false;
+    }
+
+    // Libera la reserva sólo si sigue siendo de este proceso (pudo vencer y tomarla otro)
+    void release(const QueueTask& task) {
+        const fs::path lease = leasePath(task);
+        keeper_.remove(lease.string());
+        if (firstToken(readFirstLine(lease)) != owner_) return;
+        std::error_code ec;
+        fs::remove(lease, ec);
+    }
+
+    // Publica el resultado: renombra el directorio de preparación y escribe la marca
+    bool publish(const QueueTask& task, const fs::path& staging, const fs::path& target) {
+        std::error_code ec;
+        fs::create_directories(target.parent_path(), ec);
+        fs::rename(staging, target, ec);
+        if (ec && fs::exists(done_ / task.name)) {
+            // Otro proceso publicó la misma tarea (reserva robada a un proceso vivo)
+            std::cout << "[cola] " << task.name << " ya estaba publicada; se descarta el duplicado\n";
+            fs::remove_all(staging, ec);
+            return true;
+        }
+        if (ec && fs::exists(target)) {
+            // Sin marca, lo que ocupa el destino no es un resultado confirmado (restos de una
+            // corrida anterior, o de otro proceso que todavía no escribió la marca): se aparta
+            // sin borrarlo y se publica el nuestro
+            const auto now = std::chrono::system_clock::now().time_since_epoch();
+            const fs::path aside = target.string() + ".previo." + owner_ + "." +
+                std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+            std::error_code asideEc;
+            fs::rename(target, aside, asideEc);
+            if (asideEc) {
+                std::cerr << "[cola] No se pudo apartar " << target.string() << ": "
+                          << asideEc.message() << "\n";
+                return false;
+            }
+            std::cerr << "[cola] " << target.string() << " existía sin marca de terminada; se apartó en "
+                      << aside.string() << "\n";
+            ec.clear();
+            fs::rename(staging, target, ec);
+        }
+        if (ec) {
+            std::cerr << "[cola] No se pudo publicar " << staging.string() << " en "
+                      << target.string() << ": " << ec.message() << "\n";
+            return false;
+        }
+
+        const fs::path tmp = done_ / (task.name + ".tmp." + owner_);
+        {
+            std::ofstream marker(tmp);
+            marker << owner_ << " " << target.string() << "\n";
+        }
+        fs::rename(tmp, done_ / task.name, ec);
+        return !ec;
+    }
+
+private:
+    fs::path leasePath(const QueueTask& task) const {
+        return leases_ / (task.name + ".lease");
+    }
+
+    bool expired(const fs::path& lease) const {
+        std::error_code ec;
+        const auto modified = fs::last_write_time(lease, ec);
+        if (ec) return false;   // desapareció: la próxima pasada la vuelve a intentar
+        const auto age = fs::file_time_type::clock::now() - modified;
+        return std::chrono::duration<float>(age).count() > ttl_;
+    }
+
+    static std::string readFirstLine(const fs::path& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    static std::string firstToken(const std::string& line) {
+        return line.substr(0, line.find(' '));
+    }
+
+    // Directorios de preparación que dejó el dueño de una reserva vencida (<tarea>.<dueño>.<hilo>)
+    static void removeStaging(const QueueTask& task, const std::string& staleOwner) {
+        const std::string prefix = task.name + "." + staleOwner + ".";
+        std::error_code ec;
+        for (fs::directory_iterator it(STAGING_ROOT, ec), end; !ec && it != end; it.increment(ec)) {
+            const std::string name = it->path().filename().string();
+            if (name.compare(0, prefix.size(), prefix) != 0) continue;
+            std::error_code rmEc;
+            fs::remove_all(it->path(), rmEc);
+        }
+    }
+
+    fs::path leases_;
+    fs::path done_;
+    float ttl_;
+    std::string owner_;
+    LeaseKeeper keeper_;
+};
+
+} // namespace
+
+// =========================================================
+// EJECUCIÓN
+// =========================================================
+
+bool runQueuedSweep(const std::vector<SweepSet>& sets, int workers, const std::string& queueDir,
+                    const std::function<void(SimulationContext&)>& body)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Misma lista en todos los procesos: orden del barrido, nombre = archivo + réplica
+    std::vector<QueueTask> tasks;
+    std::set<std::string> names;
+    for (int s = 0; s < (int)sets.size(); ++s) {
+        const std::string stem = fs::path(sets[s].source).stem().string();
+        for (int k = 0; k < sets[s].count; ++k) {
+            QueueTask task{stem + ".sim" + std::to_string(sets[s].firstIndex + k), s, sets[s].firstIndex + k};
+            if (!names.insert(task.name).second) {
+                std::cerr << "Error: --queue-dir: la tarea " << task.name
+                          << " aparece dos veces (archivos de parámetros con el mismo nombre).\n";
+                return false;
+            }
+            tasks.push_back(task);
+        }
+    }
+
+    DiskQueue queue(queueDir, LEASE_TTL);
+    if (!queue.prepare()) return false;
+
+    const int total = (int)tasks.size();
+    const int numThreads = std::min(std::max(1, workers), std::max(1, total));
+    const float poll = std::min(30.0f, std::max(1.0f, LEASE_TTL * 0.25f));
+
+    std::cout << "=== COLA " << queueDir << ": " << total << " tareas, " << numThreads
+              << " hilos en " << queue.owner() << " ===\n";
+
+    std::mutex printMutex;
+    std::atomic<int> ran{0};
+    const auto start = Clock::now();
+
+    auto worker = [&](int self) {
+        while (true) {
+            bool pending = false;
+            for (const QueueTask& task : tasks) {
+                if (queue.isDone(task)) continue;
+                pending = true;
+                if (!queue.claim(task)) continue;
+
+                const SweepSet& set = sets[task.set];
+                applyConfig(set.config);
+                CURRENT_SIMULATION = task.replica;
+                const fs::path target = fs::path(replicaOutputDirectory()).parent_path();
+                const fs::path staging = fs::path(STAGING_ROOT) /
+                    (task.name + "." + queue.owner() + "." + std::to_string(self));
+                std::error_code ec;
+                fs::remove_all(staging, ec);
+
+                const auto taskStart = Clock::now();
+                setReplicaStagingDirectory(staging.string() + "/");
+                runSingleReplica(task.replica, body);
+                setReplicaStagingDirectory("");
+                const bool published = queue.publish(task, staging, target);
+                queue.release(task);
+                const double taskWall = std::chrono::duration<double>(Clock::now() - taskStart).count();
+
+                ++ran;
+                std::lock_guard<std::mutex> lock(printMutex);
+                std::cout << "[cola] " << task.name << (published ? " publicada" : " SIN PUBLICAR")
+                          << " en " << std::fixed << std::setprecision(1) << taskWall
+                          << " s (hilo " << self << ")\n";
+            }
+            if (!pending) return;
+            // Lo que falta lo tienen otros procesos: esperar a que terminen o a que venza
+            std::this_thread::sleep_for(std::chrono::duration<float>(poll));
+        }
+    };
+
+    if (numThreads <= 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+        for (int t = 0; t < numThreads; ++t) threads.emplace_back(worker, t);
+        for (auto& th : threads) th.join();
+    }
+
+    const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "=== FIN DE LA COLA: " << ran.load() << " de " << total << " tareas corridas en "
+              << queue.owner() << " en " << std::fixed << std::setprecision(1) << wall << " s ===\n";
+    return true;
+}
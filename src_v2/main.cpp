@@ -16,85 +16,71 @@
 #include <set>
 #include <cstdint>
 #include <tuple>
+#include <chrono>
 
 // Headers del proyecto
 #include "Constants.h"
 #include "Initialization.h"
 #include "DataHandling.h"
+#include "SimulationContext.h"
+#include "AdaptiveStepping.h"
+#include "StateSnapshot.h"
+#include "PackingCache.h"
+#include "RandomStreams.h"
+#include "StabilityMonitor.h"
+#include "RegionOfInterest.h"
+#include "MultiRate.h"
+#include "ReinjectionSlots.h"
+#include "ParameterSweep.h"
+#include "WorkQueue.h"
+#include "TaskScheduler.h"
 
 // ==== Definiciones globales necesarias por otros .cpp ====
 // (Asegúrate de que en tus headers estén como `extern`)
 #include <box2d/box2d.h>
 
 // Coincidir exactamente con Initialization.h:
-b2WorldId worldId = b2_nullWorldId;
-std::vector<ParticleInfo>  particles;       // ⟵ corregido: ParticleInfo
-std::vector<b2BodyId>      particleBodyIds;
+thread_local b2WorldId worldId = b2_nullWorldId;
+thread_local std::vector<ParticleInfo>  particles;       // ⟵ corregido: ParticleInfo
+thread_local std::vector<b2BodyId>      particleBodyIds;
 
 // === Control de frecuencias de pasos ===
 // Se pueden sobrescribir por CLI:
 //   --exit-check-every <N>
 //   --save-frame-every <M>
-int EXIT_CHECK_EVERY_STEPS = 10;
-int SAVE_FRAME_EVERY_STEPS = 100;
+thread_local int EXIT_CHECK_EVERY_STEPS = 10;
+thread_local int SAVE_FRAME_EVERY_STEPS = 100;
 
 
 // =========================================================
-// FUNCIÓN PRINCIPAL
+// EMPAQUETAMIENTO INICIAL (partículas + sedimentación con la salida tapada)
 // =========================================================
-int main(int argc, char** argv) {
-    // Bloque temporal para tapar la salida durante sedimentación
-    b2BodyId tempOutletBlockId = b2_nullBodyId;
-
-    bool simulationInterrupted = false;
-
-    // 1) Argumentos
-    if (!parseAndValidateArgs(argc, argv)) {
-        return 1;
+// De la caché (--packing-cache) si hay un archivo con la misma clave; si no, createParticles +
+// runSedimentation en el mundo de la réplica.
+static void preparePacking(SimulationContext& ctx) {
+    const bool useCache = !PACKING_CACHE_DIR.empty();
+    const uint64_t packingSeed = (PACKING_SEED >= 0) ? (uint64_t)PACKING_SEED : (uint64_t)ctx.simulationIndex;
+    const uint64_t cacheKey = useCache ? packing::packingKey(packingSeed) : 0;
+    bool restored = false;
+    if (useCache) {
+        const auto loadStart = std::chrono::steady_clock::now();
+        restored = packing::loadPacking(worldId, cacheKey);
+        if (restored) {
+            std::cout << "Empaquetamiento restaurado de la caché (" << particles.size() << " partículas, "
+                      << std::fixed << std::setprecision(1)
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count()
+                      << " ms): " << packing::packingPath(cacheKey) << "\n";
+        } else {
+            // La generación usa la semilla del empaquetamiento: el archivo queda determinado por su clave
+            rng(RNG_PLACEMENT).seed(packingSeed, 0, RNG_PLACEMENT);
+        }
     }
 
-    // 2) Parámetros derivados
-    calculateDerivedParameters();
-
-    // 3) Archivos de salida
-    initializeDataFiles();
-
-    // 4) Impresión de parámetros iniciales
-    const float largeCircleRadius = BASE_RADIUS;
-    const float smallCircleRadius = BASE_RADIUS * SIZE_RATIO;
-
-    std::cout << "=== INICIO SIMULACIÓN GRANULAR ===\n";
-    std::cout << "Radio base (r0): " << BASE_RADIUS << " m\n";
-    std::cout << "Razón de tamaño (r): " << SIZE_RATIO << "\n";
-    std::cout << "Chi (fracción chicas): " << CHI << "\n";
-    std::cout << "Partículas circulares grandes: " << NUM_LARGE_CIRCLES
-              << " (R=" << largeCircleRadius << ")\n";
-    std::cout << "Partículas circulares pequeñas: " << NUM_SMALL_CIRCLES
-              << " (R=" << smallCircleRadius << ")\n";
-    std::cout << "Partículas poligonales: " << NUM_POLYGON_PARTICLES
-              << " (Lados=" << NUM_SIDES << ", Perímetro=" << POLYGON_PERIMETER << ")\n";
-    std::cout << "Total de partículas: " << TOTAL_PARTICLES << "\n";
-    std::cout << "Ancho silo: " << SILO_WIDTH << " m\n";
-    std::cout << "Altura silo: " << silo_height << " m\n";
-    std::cout << "Abertura silo: " << OUTLET_WIDTH
-              << " m (" << (OUTLET_WIDTH / (2.f * BASE_RADIUS)) << " diámetros base)\n";
-    std::cout << "Máx. avalanchas: " << MAX_AVALANCHES << "\n";
-    std::cout << "EXIT_CHECK_EVERY_STEPS = " << EXIT_CHECK_EVERY_STEPS << "\n";
-    std::cout << "SAVE_FRAME_EVERY_STEPS = " << SAVE_FRAME_EVERY_STEPS << "\n";
-    std::cout << "Simulaciones: " << TOTAL_SIMULATIONS << "\n\n";
-
-    // 5) Bucle de simulaciones
-    for (CURRENT_SIMULATION = 1; CURRENT_SIMULATION <= TOTAL_SIMULATIONS; ++CURRENT_SIMULATION) {
-        std::cout << "\n--- SIMULACIÓN " << CURRENT_SIMULATION << " / "
-                  << TOTAL_SIMULATIONS << " ---\n";
-
-        // 6) Mundo/Geometría
-        worldId = createWorldAndWalls(tempOutletBlockId);
-
-        // 7) Partículas
+    if (!restored) {
+        // 2) Partículas
         createParticles(worldId);
 
-        // 8) Sedimentación (con salida tapada)
+        // 3) Sedimentación (con salida tapada)
         // runSedimentation(worldId);
 
         // tras createParticles(worldId);
@@ -103,131 +89,318 @@ int main(int argc, char** argv) {
         // Si NO estabilizó, forzar extensión hasta estabilizar (sin abrir aún)
         if (!settled) {
             std::cout << "Extendiendo sedimentación hasta cumplir criterio...\n";
-            // pequeño helper in-line (no hace falta declarar función aparte)
+            // mismo criterio que runSedimentation, sin exigir |ΔE| entre chequeos
+            StabilityMonitor monitor(sedimentationCriteria());
             auto isStable = [&](void)->bool{
-                // reutiliza exactamente el MISMO criterio que adentro de runSedimentation
-                // para no duplicar lógica; acá solo hacemos un “check rápido”
-                const float KE_ABS_PER_PART_EPS    = 1e-3f;
-                const float V_SLOW_EPS             = 0.05f;
-                const float W_SLOW_EPS             = 0.2f;
-                const float SLOW_FRACTION_REQUIRED = 0.95f;
-
-                float Rmax = BASE_RADIUS;
-                if (SIZE_RATIO > 0.f) Rmax = std::max(Rmax, BASE_RADIUS * SIZE_RATIO);
-                if (NUM_POLYGON_PARTICLES > 0 && NUM_SIDES >= 3) {
-                    float ns = std::max(3, NUM_SIDES);
-                    float polyR = POLYGON_PERIMETER / (2.0f * ns * std::sin(float(M_PI)/ns));
-                    Rmax = std::max(Rmax, polyR);
-                }
-                const float pad = Rmax + 0.01f;
-                const float bandTop    = GROUND_LEVEL_Y + silo_height - pad;
-                const float yCeiling   = bandTop - 2.0f*Rmax;
-
-                float KE = 0.0f; int slow=0; float yMax=-1e30f;
-                for (const auto& p : particles) {
-                    b2Vec2 v = b2Body_GetLinearVelocity(p.bodyId);
-                    float w  = b2Body_GetAngularVelocity(p.bodyId);
-                    KE += 0.5f * p.mass * (v.x*v.x + v.y*v.y);
-                    if (std::sqrt(v.x*v.x + v.y*v.y) < V_SLOW_EPS && std::fabs(w) < W_SLOW_EPS) ++slow;
-                    b2Vec2 pos = b2Body_GetPosition(p.bodyId);
-                    if (pos.y > yMax) yMax = pos.y;
-                }
-                float KEp = (TOTAL_PARTICLES>0)? KE/TOTAL_PARTICLES : 0.f;
-                float slowFrac = (TOTAL_PARTICLES>0)? float(slow)/TOTAL_PARTICLES : 1.f;
-                bool bandClear = (yMax <= yCeiling);
-                return (KEp < KE_ABS_PER_PART_EPS && slowFrac >= SLOW_FRACTION_REQUIRED && bandClear);
+                return monitor.sample(particles).stable;
             };
 
             // Esperar hasta que isStable() sea true (sin límite, o con un cap adicional si querés)
             int guardIters = 0, guardMax = 120000; // ~ 120000 * TIME_STEP si TIME_STEP=1/240 -> 500 s máx
             while (!isStable() && guardIters++ < guardMax) {
-                b2World_Step(worldId, TIME_STEP, SUB_STEP_COUNT);
+                stepWorld(worldId, TIME_STEP, SUB_STEP_COUNT);
             }
             if (guardIters >= guardMax) {
                 std::cout << "Advertencia: guardMax alcanzado; abro igual.\n";
             } else {
                 std::cout << "Listo: condición de sedimentación lograda antes de abrir.\n";
+                settled = true;
             }
         }
 
+        // Sólo se cachean empaquetamientos que cumplieron el criterio de sedimentación
+        if (useCache) {
+            if (settled && packing::savePacking(cacheKey)) {
+                std::cout << "Empaquetamiento guardado en la caché: " << packing::packingPath(cacheKey) << "\n";
+            }
+            seedReplicaStreams(ctx.seed, (uint32_t)ctx.simulationIndex);
+        }
+    }
+}
+
+// Foto del empaquetamiento sedimentado que comparten todas las ramas de --fork-discharges.
+// Se arma una sola vez antes de lanzar las réplicas y después sólo se lee.
+static packing::Packing forkPacking;
+
+static void prepareForkPacking() {
+    SimulationContext ctx;
+    ctx.simulationIndex = CURRENT_SIMULATION;
+    ctx.seed = (uint64_t)RANDOM_SEED;
+    resetRunState(ctx.simulationIndex, ctx.seed);
+    particles.clear();
+    particleBodyIds.clear();
+    stateSnapshot = StateSnapshot();
+
+    std::cout << "\n--- EMPAQUETAMIENTO COMÚN (--fork-discharges) ---\n";
+    worldId = createWorldAndWalls(ctx.outletBlockId);
+    ctx.worldId = worldId;
+    preparePacking(ctx);
+    packing::capturePacking(0, forkPacking);
+
+    destroyWorld(worldId);
+    worldId = b2_nullWorldId;
+    particles.clear();
+    particleBodyIds.clear();
+    stateSnapshot = StateSnapshot();
+    std::cout << "Foto común lista: " << forkPacking.particles.size()
+              << " partículas; cada réplica la copia y sólo cambia su flujo aleatorio.\n";
+}
+
 
-        // 9) Apertura del silo
-        std::cout << "ABRIENDO SILO: eliminando bloqueo temporal...\n";
-        b2DestroyBody(tempOutletBlockId);
-        std::cout << "SILO ABIERTO: iniciando fase de flujo.\n";
-
-        // Reiniciar tiempo y contadores tras sedimentación
-        simulationTime = 0.0f;
-
-        int   exitedTotalCount    = 0;
-        float exitedTotalMass     = 0.0f;
-        int   exitedOriginalCount = 0;
-        float exitedOriginalMass  = 0.0f;
-        float timeSinceLastExit   = 0.0f;
-
-        // 10) Bucle principal
-        while (avalancheCount < MAX_AVALANCHES && !simulationInterrupted) {
-            // Integración
-            b2World_Step(worldId, TIME_STEP, SUB_STEP_COUNT);
-            simulationTime += TIME_STEP;
-            frameCounter++;
-
-            // Manejo de partículas salientes (cada N pasos)
-            if (frameCounter % EXIT_CHECK_EVERY_STEPS == 0) {
-                manageParticles(
-                    worldId, simulationTime, silo_height,
-                    exitedTotalCount, exitedTotalMass,
-                    exitedOriginalCount, exitedOriginalMass
-                );
+// =========================================================
+// UNA RÉPLICA COMPLETA (mundo, sedimentación y flujo)
+// =========================================================
+// Se ejecuta en el hilo de la réplica: todo el estado global de corrida es thread_local.
+// runReplicas abre los archivos antes (beginReplica) y cierra/destruye el mundo después.
+static void runReplica(SimulationContext& ctx) {
+    std::cout << "\n--- SIMULACIÓN " << ctx.simulationIndex << " / "
+              << TOTAL_SIMULATIONS << " ---\n";
+
+    // 1) Mundo/Geometría
+    worldId = createWorldAndWalls(ctx.outletBlockId);
+    ctx.worldId = worldId;
+
+    // 2-3) Empaquetamiento: la foto común de --fork-discharges, la caché o creado y sedimentado acá
+    if (!forkPacking.empty()) {
+        packing::restorePacking(worldId, forkPacking);
+    } else {
+        preparePacking(ctx);
+    }
+
+
+    // 4) Apertura del silo
+    std::cout << "ABRIENDO SILO: eliminando bloqueo temporal...\n";
+    b2DestroyBody(ctx.outletBlockId);
+    std::cout << "SILO ABIERTO: iniciando fase de flujo.\n";
+
+    // Reiniciar tiempo y contadores tras sedimentación
+    simulationTime = 0.0f;
+
+    int   exitedTotalCount    = 0;
+    float exitedTotalMass     = 0.0f;
+    int   exitedOriginalCount = 0;
+    float exitedOriginalMass  = 0.0f;
+    float timeSinceLastExit   = 0.0f;
+
+    // Rendimiento de la fase de flujo (pasos/s de reloj de pared)
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point flowWallStart = Clock::now();
+    Clock::time_point lastReportWall = flowWallStart;
+    long long flowSteps = 0, lastReportSteps = 0;
+    long long flowSubSteps = 0;
+    const std::vector<long long> itemsAtFlowStart = defaultTaskScheduler().itemsPerWorker();
+
+    // Paso adaptativo (--adaptive-dt 1); si no, TIME_STEP/SUB_STEP_COUNT fijos
+    AdaptiveStepController stepController;
+    if (ADAPTIVE_STEPPING) stepController.reset(worldId, particles);
+    float lastStepLogTime = -RECORD_INTERVAL;
+
+    // Región de interés (--roi-height): congela el volumen lejano al orificio
+    RoiController roi;
+    if (ROI_HEIGHT > 0.0f) {
+        roi.reset(particles);
+        std::cout << "Región de interés: " << roi.frozenCount() << " partículas congeladas por encima de "
+                  << ROI_HEIGHT << " aberturas\n";
+    }
+
+    // Lugares de reinyección para las partículas de esta réplica
+    reinjectionSlots.reset();
+
+    // Retención multi-paso (--multirate k): volumen lejano cinemático k-1 de cada k pasos
+    MultiRateController multiRate;
+    if (MULTIRATE_RATIO > 1) multiRate.reset(worldId, particles);
+
+    // 5) Bucle principal
+    long long fastForwards = 0;
+    float fastForwardTime = 0.0f;
+    while (avalancheCount < MAX_AVALANCHES && !ctx.interrupted) {
+        // Atasco con todo dormido: el tiempo salta hasta el próximo desarme
+        if (JAM_FAST_FORWARD && inBlockage &&
+            (ROI_HEIGHT > 0.0f ? roi.quiescent() : worldQuiescent(worldId))) {
+            const float before = simulationTime;
+            if (fastForwardJam()) {
+                ++fastForwards;
+                fastForwardTime += simulationTime - before;
             }
+        }
 
-            // Registro de flujo
-            recordFlowData(
-                simulationTime,
+        // Integración
+        StepChoice step = {TIME_STEP, SUB_STEP_COUNT};
+        if (ADAPTIVE_STEPPING) {
+            step = stepController.choose(particles);
+            if (simulationTime - lastStepLogTime >= RECORD_INTERVAL) {
+                adaptiveStepFile << std::fixed << std::setprecision(5) << simulationTime << ","
+                                 << std::setprecision(7) << step.dt << "," << step.subSteps << ","
+                                 << std::setprecision(5) << stepController.maxSpeed() << ","
+                                 << stepController.maxOverlap() << "\n";
+                lastStepLogTime = simulationTime;
+            }
+        }
+        if (MULTIRATE_RATIO > 1) multiRate.beforeStep(particles);
+        stepWorld(worldId, step.dt, step.subSteps);
+        if (MULTIRATE_RATIO > 1) multiRate.afterStep(step.dt, particles);
+        simulationTime += step.dt;
+        frameCounter++;
+        flowSteps++;
+        flowSubSteps += step.subSteps;
+
+        if (ROI_HEIGHT > 0.0f) roi.update(simulationTime, particles);
+
+        // Manejo de partículas salientes: por sensores en cada paso (tiempo de salida exacto)
+        // o por barrido de posiciones cada N pasos
+        if (USE_EXIT_SENSORS) {
+            manageParticlesFromSensors(
+                worldId, simulationTime, silo_height,
+                exitedTotalCount, exitedTotalMass,
+                exitedOriginalCount, exitedOriginalMass
+            );
+        }
+        else if (frameCounter % EXIT_CHECK_EVERY_STEPS == 0) {
+            manageParticles(
+                worldId, simulationTime, silo_height,
                 exitedTotalCount, exitedTotalMass,
                 exitedOriginalCount, exitedOriginalMass
             );
+        }
 
-            // Estado (avalanchas / bloqueos)
-            timeSinceLastExit = simulationTime - lastParticleExitTime;
-            checkFlowStatus(worldId, timeSinceLastExit);
+        // Registro de flujo
+        recordFlowData(
+            simulationTime,
+            exitedTotalCount, exitedTotalMass,
+            exitedOriginalCount, exitedOriginalMass
+        );
 
-            // Interrupción por bloqueo persistente
-            if (inBlockage && blockageRetryCount > MAX_BLOCKAGE_RETRIES) {
-                simulationInterrupted = true;
-            }
+        // Estado (avalanchas / bloqueos)
+        timeSinceLastExit = simulationTime - lastParticleExitTime;
+        checkFlowStatus(worldId, timeSinceLastExit);
 
-            // Log periódico (~cada 5s sim)
-            if (simulationTime - lastPrintTime >= 5.0f) {
-                std::string state = inAvalanche ? "AVALANCHA" : (inBlockage ? "BLOQUEO" : "INICIAL");
-                std::cout << "t=" << std::fixed << std::setprecision(2) << simulationTime
-                          << "s | salieron=" << totalExitedParticles
-                          << " | avalanchas=" << avalancheCount << "/" << MAX_AVALANCHES
-                          << " | estado=" << state << "\n";
-                lastPrintTime = simulationTime;
-            }
+        // Interrupción por bloqueo persistente
+        if (inBlockage && blockageRetryCount > MAX_BLOCKAGE_RETRIES) {
+            ctx.interrupted = true;
+        }
 
-            // Guardado de "frames" de partículas cada M pasos
-            if (SAVE_SIMULATION_DATA && (frameCounter % SAVE_FRAME_EVERY_STEPS == 0)) {
-                simulationDataFile << std::fixed << std::setprecision(5) << simulationTime;
-                for (const auto& p : particles) {     // p es ParticleInfo
-                    b2Vec2 pos   = b2Body_GetPosition(p.bodyId);
-                    float  angle = b2Rot_GetAngle(b2Body_GetRotation(p.bodyId));
-                    simulationDataFile << ","
-                                       << pos.x << "," << pos.y << ","
-                                       << p.shapeType << ","
-                                       << p.size << ","
-                                       << p.numSides << ","
-                                       << angle;
-                }
-                simulationDataFile << "\n";
-            }
-        } // while
+        // Log periódico (~cada 5s sim)
+        if (simulationTime - lastPrintTime >= 5.0f) {
+            std::string state = inAvalanche ? "AVALANCHA" : (inBlockage ? "BLOQUEO" : "INICIAL");
+            const Clock::time_point now = Clock::now();
+            const double wall = std::chrono::duration<double>(now - lastReportWall).count();
+            const double stepsPerSec = (wall > 0.0) ? (flowSteps - lastReportSteps) / wall : 0.0;
+            std::cout << "t=" << std::fixed << std::setprecision(2) << simulationTime
+                      << "s | salieron=" << totalExitedParticles
+                      << " | avalanchas=" << avalancheCount << "/" << MAX_AVALANCHES
+                      << " | estado=" << state
+                      << " | pasos/s=" << std::setprecision(1) << stepsPerSec << "\n";
+            lastPrintTime = simulationTime;
+            lastReportWall = now;
+            lastReportSteps = flowSteps;
+        }
 
-        // 11) Cierre de archivos y destrucción del mundo
-        finalizeDataFiles(simulationInterrupted);
-        b2DestroyWorld(worldId);
-    } // for
+        // Guardado de "frames" de partículas cada M pasos (simulation_data.bin)
+        if (SAVE_SIMULATION_DATA && (frameCounter % SAVE_FRAME_EVERY_STEPS == 0)) {
+            recordFrame(frameCounter, simulationTime);
+        }
+    } // while
+
+    const double flowWall = std::chrono::duration<double>(Clock::now() - flowWallStart).count();
+    std::cout << "Rendimiento flujo: " << flowSteps << " pasos en "
+              << std::fixed << std::setprecision(2) << flowWall << " s = "
+              << std::setprecision(1) << ((flowWall > 0.0) ? flowSteps / flowWall : 0.0)
+              << " pasos/s (" << NUM_THREADS << " hilos, " << TOTAL_PARTICLES << " partículas)\n";
+    if (NUM_THREADS > 1) {
+        // Bloques de tareas de Box2D (solver incluido) que ejecutó cada hilo en la fase de flujo
+        const std::vector<long long> items = defaultTaskScheduler().itemsPerWorker();
+        std::cout << "Bloques de tareas por hilo:";
+        for (size_t w = 0; w < items.size(); ++w) {
+            std::cout << " " << (items[w] - (w < itemsAtFlowStart.size() ? itemsAtFlowStart[w] : 0));
+        }
+        std::cout << "\n";
+    }
+    if (simulationTime > 0.0f) {
+        std::cout << "Subpasos por segundo simulado: " << std::setprecision(0)
+                  << (flowSubSteps / simulationTime)
+                  << (ADAPTIVE_STEPPING ? " (paso adaptativo)" : "") << "\n";
+    }
+    if (reinjectionSlots.fallbacks() > 0) {
+        std::cout << "Reinyecciones sin lugar libre en la banda: " << reinjectionSlots.fallbacks() << "\n";
+    }
+    if (MULTIRATE_RATIO > 1) {
+        std::cout << "Multi-paso (k=" << MULTIRATE_RATIO << "): " << std::setprecision(1)
+                  << 100.0 * multiRate.dynamicFraction() << "% de los pasos partícula dinámicos (subpasos sin cambio)\n";
+    }
+    if (ROI_HEIGHT > 0.0f) {
+        std::cout << "Región de interés: " << roi.frozenCount() << " congeladas al final, "
+                  << roi.thawCount() << " descongelamientos, " << roi.freezeCount() << " recongelamientos\n";
+    }
+    if (fastForwards > 0) {
+        std::cout << "Atascos dormidos salteados: " << fastForwards << " ("
+                  << std::setprecision(2) << fastForwardTime << " s simulados sin integrar)\n";
+    }
+}
+
+
+// =========================================================
+// FUNCIÓN PRINCIPAL
+// =========================================================
+int main(int argc, char** argv) {
+    // 1) Argumentos
+    if (!parseAndValidateArgs(argc, argv)) {
+        return 1;
+    }
+
+    if (RANDOM_SEED < 0) {
+        RANDOM_SEED = (long long)std::chrono::system_clock::now().time_since_epoch().count() & 0x7FFFFFFFFFFFFFFFll;
+    }
+
+    // Barrido: cada archivo de parámetros se aplica sobre la línea de comandos (sin derivar)
+    if (!SWEEP_SOURCE.empty()) {
+        std::vector<SweepSet> sets;
+        if (!loadParameterSweep(SWEEP_SOURCE, sets)) {
+            return 1;
+        }
+        std::cout << "Semilla (--seed): " << RANDOM_SEED << "\n";
+        if (!QUEUE_DIR.empty()) {
+            return runQueuedSweep(sets, sweepWorkerCount(sets), QUEUE_DIR, runReplica) ? 0 : 1;
+        }
+        runParameterSweep(sets, sweepWorkerCount(sets), runReplica);
+        return 0;
+    }
+
+    // 2) Parámetros derivados
+    calculateDerivedParameters();
+
+    // 3) Impresión de parámetros iniciales
+    const float largeCircleRadius = BASE_RADIUS;
+    const float smallCircleRadius = BASE_RADIUS * SIZE_RATIO;
+
+    std::cout << "=== INICIO SIMULACIÓN GRANULAR ===\n";
+    std::cout << "Radio base (r0): " << BASE_RADIUS << " m\n";
+    std::cout << "Razón de tamaño (r): " << SIZE_RATIO << "\n";
+    std::cout << "Chi (fracción chicas): " << CHI << "\n";
+    std::cout << "Partículas circulares grandes: " << NUM_LARGE_CIRCLES
+              << " (R=" << largeCircleRadius << ")\n";
+    std::cout << "Partículas circulares pequeñas: " << NUM_SMALL_CIRCLES
+              << " (R=" << smallCircleRadius << ")\n";
+    std::cout << "Partículas poligonales: " << NUM_POLYGON_PARTICLES
+              << " (Lados=" << NUM_SIDES << ", Perímetro=" << POLYGON_PERIMETER << ")\n";
+    std::cout << "Total de partículas: " << TOTAL_PARTICLES << "\n";
+    std::cout << "Ancho silo: " << SILO_WIDTH << " m\n";
+    std::cout << "Altura silo: " << silo_height << " m\n";
+    std::cout << "Abertura silo: " << OUTLET_WIDTH
+              << " m (" << (OUTLET_WIDTH / (2.f * BASE_RADIUS)) << " diámetros base)\n";
+    std::cout << "Máx. avalanchas: " << MAX_AVALANCHES << "\n";
+    std::cout << "EXIT_CHECK_EVERY_STEPS = " << EXIT_CHECK_EVERY_STEPS << "\n";
+    std::cout << "SAVE_FRAME_EVERY_STEPS = " << SAVE_FRAME_EVERY_STEPS << "\n";
+    std::cout << "Hilos (b2World_Step): " << NUM_THREADS << "\n";
+    std::cout << "Semilla (--seed): " << RANDOM_SEED << "\n";
+    std::cout << "Simulaciones: " << TOTAL_SIMULATIONS
+              << " (en paralelo: " << PARALLEL_REPLICAS << ")\n\n";
+
+    // 4) Réplicas: en serie o --parallel-replicas K hilos, cada una con su SimulationContext.
+    //    Con --fork-discharges todas parten de la misma foto sedimentada.
+    if (FORK_DISCHARGES) {
+        prepareForkPacking();
+    }
+    runReplicas(CURRENT_SIMULATION, TOTAL_SIMULATIONS, PARALLEL_REPLICAS, runReplica);
 
     std::cout << "\n=== FIN DE TODAS LAS SIMULACIONES ===\n";
     return 0;
@@ -0,0 +1,77 @@
+// tools/frames_extract.cpp
+//
+// Extrae de simulation_data.bin sólo los frames pedidos y los escribe como CSV histórico por
+// stdout (lo que leen los renderers), sin cargar la corrida completa en memoria.
+//
+//   ./bin/frames_extract <simulation_data.bin> [--min-time t] [--max-time t] [--frame-step k]
+//   ./bin/frames_extract <simulation_data.bin> --count [--min-time t] [--max-time t]
+//
+// --count imprime "<frames> <t_inicial> <t_final>" del rango sin decodificar ningún frame.
+
+#include "FrameStore.h"
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+
+static void printUsage(const char* prog) {
+    std::cerr << "Uso: " << prog << " <simulation_data.bin> [--min-time t] [--max-time t]"
+              << " [--frame-step k] [--count]\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    double minTime = -std::numeric_limits<double>::infinity();
+    double maxTime =  std::numeric_limits<double>::infinity();
+    long   frameStep = 1;
+    bool   countOnly = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--min-time" && i + 1 < argc)        minTime = std::stod(argv[++i]);
+        else if (arg == "--max-time" && i + 1 < argc)   maxTime = std::stod(argv[++i]);
+        else if (arg == "--frame-step" && i + 1 < argc) frameStep = std::stol(argv[++i]);
+        else if (arg == "--count")                      countOnly = true;
+        else {
+            std::cerr << "Argumento desconocido: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (frameStep < 1) frameStep = 1;
+
+    frames::FrameStore store;
+    if (!store.open(argv[1])) {
+        std::cerr << "Error: '" << argv[1] << "' no es un archivo de frames válido\n";
+        return 1;
+    }
+
+    if (countOnly) {
+        const std::vector<size_t> all = store.select(minTime, maxTime, 1);
+        if (all.empty()) {
+            std::printf("0 0 0\n");
+        } else {
+            std::printf("%zu %.5f %.5f\n", all.size(), store.time(all.front()), store.time(all.back()));
+        }
+        return 0;
+    }
+
+    static char outBuffer[1 << 20];
+    std::setvbuf(stdout, outBuffer, _IOFBF, sizeof(outBuffer));
+
+    frames::writeCsvHeader(stdout, store.particleCount());
+    frames::Frame frame;
+    for (size_t k : store.select(minTime, maxTime, (size_t)frameStep)) {
+        if (!store.read(k, frame)) {
+            std::cerr << "Error: frame " << k << " dañado; se corta la extracción\n";
+            return 1;
+        }
+        frames::writeCsvRow(stdout, store.columns(), frame);
+    }
+    std::fflush(stdout);
+    return 0;
+}
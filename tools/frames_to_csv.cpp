@@ -0,0 +1,45 @@
+// tools/frames_to_csv.cpp
+//
+// Convierte simulation_data.bin al simulation_data.csv histórico (mismas columnas y formato)
+// para los scripts que todavía leen el CSV.
+//
+//   ./bin/frames_to_csv <simulation_data.bin> [salida.csv]     (sin salida: stdout)
+
+#include "FrameFormat.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Uso: " << argv[0] << " <simulation_data.bin> [salida.csv]\n";
+        return 1;
+    }
+
+    frames::FrameReader reader;
+    if (!reader.open(argv[1])) {
+        std::cerr << "Error: '" << argv[1] << "' no es un archivo de frames válido\n";
+        return 1;
+    }
+
+    std::FILE* out = stdout;
+    if (argc == 3) {
+        out = std::fopen(argv[2], "w");
+        if (!out) {
+            std::cerr << "Error: no se pudo crear '" << argv[2] << "'\n";
+            return 1;
+        }
+    }
+
+    frames::writeCsvHeader(out, reader.particleCount());
+    frames::Frame frame;
+    long long count = 0;
+    while (reader.next(frame)) {
+        frames::writeCsvRow(out, reader.columns(), frame);
+        ++count;
+    }
+
+    if (out != stdout) std::fclose(out);
+    std::cerr << "Frames convertidos: " << count << " (" << reader.particleCount() << " partículas)\n";
+    return 0;
+}
@@ -0,0 +1,471 @@
+// tools/silo_bench.cpp
+//
+// Microbenchmarks de los caminos calientes del simulador (make bench). Cada caso arma su escena
+// con la semilla fija en un hilo nuevo (el planificador de Box2D es por hilo y toma --threads
+// al crearse), repite la medición y guarda los resultados en JSON para comparar entre commits.
+//
+//   ./bin/silo_bench [--output bench_results.json] [--repeats R] [--quick] [--filter texto]
+//                    [--commit id] [--verbose]
+//
+// Casos:
+//   step/...           b2World_Step (stepWorld) por partículas, forma, subpasos e hilos
+//   manage_particles   manageParticles con el orificio abierto y partículas saliendo
+//   arch_raycast       detectAndReinjectArchViaRaycast sobre el empaquetamiento apoyado en la tapa
+//   create_particles   createParticles (colocación sin superposición) en un mundo vacío
+//   frame_writer/...   recordFrame con el códec raw y delta
+//   multirate/...      paso de la descarga con --multirate k (k = 1 es la referencia)
+
+#include "Constants.h"
+#include "Initialization.h"
+#include "DataHandling.h"
+#include "MultiRate.h"
+#include "SimulationContext.h"
+#include "StateSnapshot.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+// Definiciones que en el simulador vienen de main.cpp
+thread_local b2WorldId worldId = b2_nullWorldId;
+thread_local std::vector<ParticleInfo> particles;
+thread_local std::vector<b2BodyId> particleBodyIds;
+thread_local int EXIT_CHECK_EVERY_STEPS = 10;
+thread_local int SAVE_FRAME_EVERY_STEPS = 100;
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+const uint64_t BENCH_SEED = 12345;
+const char* SCRATCH_DIR = "./bench_tmp";
+
+// =========================================================
+// RESULTADOS
+// =========================================================
+
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    std::vector<double> samples;     // segundos por operación
+    std::string unit;                // qué cuenta workPerOp (partículas, pasos partícula, bytes)
+    double workPerOp = 0.0;
+    double bytesPerOp = 0.0;         // sólo frame_writer
+};
+
+struct Stats {
+    double median = 0, mean = 0, min = 0, max = 0, stddev = 0;
+};
+
+Stats computeStats(std::vector<double> v) {
+    Stats s;
+    if (v.empty()) return s;
+    std::sort(v.begin(), v.end());
+    const size_t n = v.size();
+    s.median = (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+    s.min = v.front();
+    s.max = v.back();
+    for (double x : v) s.mean += x;
+    s.mean /= n;
+    for (double x : v) s.stddev += (x - s.mean) * (x - s.mean);
+    s.stddev = (n > 1) ? std::sqrt(s.stddev / (n - 1)) : 0.0;
+    return s;
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// =========================================================
+// ESCENA
+// =========================================================
+
+struct SceneSpec {
+    int particles = 2000;
+    int sides = 0;                   // 0 = discos; >= 3 = polígonos de ese número de lados
+    int threads = 1;
+};
+
+// Configuración de la escena en el hilo actual (que arranca con los valores por defecto)
+void configure(const SceneSpec& spec) {
+    TOTAL_PARTICLES = spec.particles;
+    SIZE_RATIO = 0.0f;
+    CHI = 0.0f;
+    NUM_SIDES = spec.sides;
+    NUM_POLYGON_PARTICLES = (spec.sides > 0) ? spec.particles : 0;
+    NUM_THREADS = spec.threads;
+    SAVE_SIMULATION_DATA = false;
+    calculateDerivedParameters();
+    markConfigApplied();
+}
+
+// Réplica de banco: archivos en SCRATCH_DIR y mundo con la tapa del orificio puesta
+void openScene(SimulationContext& ctx, const std::string& tag) {
+    setReplicaStagingDirectory(std::string(SCRATCH_DIR) + "/" + tag + "/");
+    ctx.simulationIndex = 1;
+    ctx.seed = BENCH_SEED;
+    beginReplica(ctx);
+    worldId = createWorldAndWalls(ctx.outletBlockId);
+    ctx.worldId = worldId;
+}
+
+void closeScene(SimulationContext& ctx) {
+    endReplica(ctx);
+    setReplicaStagingDirectory("");
+}
+
+void settle(int steps, int subSteps = 4) {
+    for (int s = 0; s < steps; ++s) stepWorld(worldId, TIME_STEP, subSteps);
+}
+
+double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Corre fn en un hilo nuevo (estado thread_local y planificador de Box2D limpios)
+void runIsolated(bool verbose, const std::function<void()>& fn) {
+    std::ostringstream sink;
+    std::streambuf* saved = nullptr;
+    if (!verbose) saved = std::cout.rdbuf(sink.rdbuf());
+    std::thread th(fn);
+    th.join();
+    if (saved) std::cout.rdbuf(saved);
+}
+
+// =========================================================
+// CASOS
+// =========================================================
+
+BenchResult benchStep(const SceneSpec& spec, int subSteps, int repeats, int stepsPerSample, bool verbose) {
+    BenchResult r;
+    r.name = "step";
+    r.params = {{"particles", std::to_string(spec.particles)},
+                {"shape", spec.sides > 0 ? "polygon" : "disc"},
+                {"sides", std::to_string(spec.sides)},
+                {"substeps", std::to_string(subSteps)},
+                {"threads", std::to_string(spec.threads)}};
+    r.unit = "particle_steps";
+    runIsolated(verbose, [&] {
+        configure(spec);
+        SimulationContext ctx;
+        openScene(ctx, "step");
+        createParticles(worldId);
+        settle(200);
+        r.workPerOp = (double)particles.size();
+        const std::vector<long long> itemsBefore = defaultTaskScheduler().itemsPerWorker();
+        for (int rep = 0; rep < repeats; ++rep) {
+            const auto t0 = Clock::now();
+            for (int s = 0; s < stepsPerSample; ++s) stepWorld(worldId, TIME_STEP, subSteps);
+            r.samples.push_back(secondsSince(t0) / stepsPerSample);
+        }
+        // Hilos que ejecutaron bloques de tareas (solver incluido) durante la medición
+        const std::vector<long long> itemsAfter = defaultTaskScheduler().itemsPerWorker();
+        int workersUsed = 0;
+        for (size_t w = 0; w < itemsAfter.size(); ++w) {
+            if (itemsAfter[w] > (w < itemsBefore.size() ? itemsBefore[w] : 0)) ++workersUsed;
+        }
+        r.params.push_back({"workers_used", std::to_string(workersUsed)});
+        closeScene(ctx);
+    });
+    return r;
+}
+
+BenchResult benchManageParticles(const SceneSpec& spec, int calls, bool verbose) {
+    BenchResult r;
+    r.name = "manage_particles";
+    r.params = {{"particles", std::to_string(spec.particles)},
+                {"check_every", std::to_string(EXIT_CHECK_EVERY_STEPS)}};
+    r.unit = "particles";
+    runIsolated(verbose, [&] {
+        configure(spec);
+        SimulationContext ctx;
+        openScene(ctx, "manage");
+        createParticles(worldId);
+        settle(200);
+        b2DestroyBody(ctx.outletBlockId);
+        settle(400);
+
+        r.workPerOp = (double)particles.size();
+        int exitedCount = 0, exitedOriginal = 0;
+        float exitedMass = 0.0f, exitedOriginalMass = 0.0f;
+        for (int c = 0; c < calls; ++c) {
+            for (int s = 0; s < EXIT_CHECK_EVERY_STEPS; ++s) stepWorld(worldId, TIME_STEP, SUB_STEP_COUNT);
+            simulationTime += EXIT_CHECK_EVERY_STEPS * TIME_STEP;
+            const auto t0 = Clock::now();
+            manageParticles(worldId, simulationTime, silo_height,
+                            exitedCount, exitedMass, exitedOriginal, exitedOriginalMass);
+            r.samples.push_back(secondsSince(t0));
+        }
+        r.params.push_back({"exited", std::to_string(exitedCount)});
+        closeScene(ctx);
+    });
+    return r;
+}
+
+BenchResult benchArchRaycast(const SceneSpec& spec, int calls, bool verbose) {
+    BenchResult r;
+    r.name = "arch_raycast";
+    r.params = {{"particles", std::to_string(spec.particles)}};
+    r.unit = "calls";
+    r.workPerOp = 1.0;
+    runIsolated(verbose, [&] {
+        configure(spec);
+        SimulationContext ctx;
+        openScene(ctx, "raycast");
+        createParticles(worldId);
+        settle(600);
+        for (int c = 0; c < calls; ++c) {
+            settle(5);
+            const auto t0 = Clock::now();
+            detectAndReinjectArchViaRaycast(worldId, silo_height);
+            r.samples.push_back(secondsSince(t0));
+        }
+        closeScene(ctx);
+    });
+    return r;
+}
+
+BenchResult benchCreateParticles(const SceneSpec& spec, int repeats, bool verbose) {
+    BenchResult r;
+    r.name = "create_particles";
+    r.params = {{"particles", std::to_string(spec.particles)},
+                {"shape", spec.sides > 0 ? "polygon" : "disc"},
+                {"sides", std::to_string(spec.sides)}};
+    r.unit = "particles";
+    runIsolated(verbose, [&] {
+        configure(spec);
+        for (int rep = 0; rep < repeats; ++rep) {
+            SimulationContext ctx;
+            openScene(ctx, "create");
+            const auto t0 = Clock::now();
+            createParticles(worldId);
+            r.samples.push_back(secondsSince(t0));
+            r.workPerOp = (double)particles.size();
+            closeScene(ctx);
+        }
+    });
+    return r;
+}
+
+BenchResult benchFrameWriter(const SceneSpec& spec, int codec, int frames, bool verbose) {
+    BenchResult r;
+    r.name = "frame_writer";
+    r.params = {{"particles", std::to_string(spec.particles)},
+                {"codec", codec == 1 ? "delta" : "raw"}};
+    r.unit = "particles";
+    runIsolated(verbose, [&] {
+        configure(spec);
+        FRAME_CODEC = codec;
+        ASYNC_OUTPUT = false;        // el costo de escritura se mide en el hilo que graba
+        SimulationContext ctx;
+        const std::string tag = std::string("frames_") + (codec == 1 ? "delta" : "raw");
+        openScene(ctx, tag);
+        createParticles(worldId);
+        settle(100);
+        b2DestroyBody(ctx.outletBlockId);
+        r.workPerOp = (double)particles.size();
+        for (int f = 0; f < frames; ++f) {
+            settle(5, SUB_STEP_COUNT);
+            const auto t0 = Clock::now();
+            recordFrame((uint64_t)f, f * 5 * TIME_STEP);
+            r.samples.push_back(secondsSince(t0));
+        }
+        closeScene(ctx);
+
+        std::error_code ec;
+        const auto bytes = fs::file_size(fs::path(SCRATCH_DIR) / tag / "simulation_data.bin", ec);
+        if (!ec && frames > 0) r.bytesPerOp = (double)bytes / frames;
+    });
+    return r;
+}
+
+BenchResult benchMultiRate(const SceneSpec& spec, int ratio, int repeats, int stepsPerSample, bool verbose) {
+    BenchResult r;
+    r.name = "multirate";
+    r.params = {{"particles", std::to_string(spec.particles)},
+                {"ratio", std::to_string(ratio)}};
+    r.unit = "particle_steps";
+    runIsolated(verbose, [&] {
+        configure(spec);
+        MULTIRATE_RATIO = ratio;
+        SimulationContext ctx;
+        openScene(ctx, "multirate");
+        createParticles(worldId);
+        settle(200);
+        b2DestroyBody(ctx.outletBlockId);
+        settle(200, SUB_STEP_COUNT);
+
+        MultiRateController multiRate;
+        multiRate.reset(worldId, particles);
+        r.workPerOp = (double)particles.size();
+        for (int rep = 0; rep < repeats; ++rep) {
+            const auto t0 = Clock::now();
+            for (int s = 0; s < stepsPerSample; ++s) {
+                if (ratio > 1) multiRate.beforeStep(particles);
+                stepWorld(worldId, TIME_STEP, SUB_STEP_COUNT);
+                if (ratio > 1) multiRate.afterStep(TIME_STEP, particles);
+            }
+            r.samples.push_back(secondsSince(t0) / stepsPerSample);
+        }
+        std::ostringstream fraction;
+        fraction << std::fixed << std::setprecision(3) << multiRate.dynamicFraction();
+        r.params.push_back({"dynamic_fraction", fraction.str()});
+        closeScene(ctx);
+    });
+    return r;
+}
+
+// =========================================================
+// SALIDA
+// =========================================================
+
+void printResult(const BenchResult& r) {
+    const Stats s = computeStats(r.samples);
+    std::cout << std::left << std::setw(18) << r.name;
+    for (const auto& [k, v] : r.params) std::cout << " " << k << "=" << v;
+    std::cout << std::right << std::fixed << std::setprecision(3)
+              << " | mediana " << s.median * 1e3 << " ms";
+    if (s.median > 0.0 && r.workPerOp > 0.0) {
+        std::cout << " | " << std::setprecision(0) << r.workPerOp / s.median << " " << r.unit << "/s";
+    }
+    if (r.bytesPerOp > 0.0) std::cout << " | " << std::setprecision(0) << r.bytesPerOp << " B/frame";
+    std::cout << "\n";
+}
+
+bool writeJson(const std::string& path, const std::string& commit, int repeats,
+               const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    char host[256] = {0};
+    gethostname(host, sizeof(host) - 1);
+    const std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n";
+    out << "  \"commit\": \"" << jsonEscape(commit) << "\",\n";
+    out << "  \"date\": \"" << date << "\",\n";
+    out << "  \"host\": \"" << jsonEscape(host) << "\",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"seed\": " << BENCH_SEED << ",\n";
+    out << "  \"repeats\": " << repeats << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        const Stats s = computeStats(r.samples);
+        out << "    {\"name\": \"" << r.name << "\", \"params\": {";
+        for (size_t p = 0; p < r.params.size(); ++p) {
+            out << (p ? ", " : "") << "\"" << r.params[p].first << "\": \"" << jsonEscape(r.params[p].second) << "\"";
+        }
+        out << "}, \"samples\": " << r.samples.size()
+            << std::scientific << std::setprecision(6)
+            << ", \"median_s\": " << s.median << ", \"mean_s\": " << s.mean
+            << ", \"min_s\": " << s.min << ", \"max_s\": " << s.max << ", \"stddev_s\": " << s.stddev
+            << ", \"unit\": \"" << r.unit << "\", \"work_per_op\": " << r.workPerOp
+            << ", \"throughput_per_s\": " << ((s.median > 0.0) ? r.workPerOp / s.median : 0.0);
+        if (r.bytesPerOp > 0.0) out << ", \"bytes_per_op\": " << r.bytesPerOp;
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        out << std::defaultfloat;
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+} // namespace
+
+// =========================================================
+// PRINCIPAL
+// =========================================================
+
+int main(int argc, char** argv) {
+    std::string output = "bench_results.json";
+    std::string commit = "desconocido";
+    std::string filter;
+    int repeats = 5;
+    bool quick = false;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) output = argv[++i];
+        else if (arg == "--commit" && i + 1 < argc) commit = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--repeats" && i + 1 < argc) repeats = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--quick") quick = true;
+        else if (arg == "--verbose") verbose = true;
+        else {
+            std::cerr << "Uso: " << argv[0] << " [--output archivo.json] [--repeats R] [--quick]"
+                         " [--filter texto] [--commit id] [--verbose]\n";
+            return 1;
+        }
+    }
+    auto selected = [&](const std::string& name) {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    };
+
+    const std::vector<int> sizes = quick ? std::vector<int>{500} : std::vector<int>{500, 2000};
+    const std::vector<int> shapes = {0, 5};
+    const std::vector<int> subSteps = quick ? std::vector<int>{4} : std::vector<int>{4, SUB_STEP_COUNT};
+    std::vector<int> threads = {1};
+    const int hw = (int)std::thread::hardware_concurrency();
+    if (hw > 1) threads.push_back(std::min(hw, 8));
+    const int steps = quick ? 10 : 25;
+    const int calls = quick ? 20 : 100;
+
+    std::vector<BenchResult> results;
+    auto add = [&](BenchResult r) {
+        printResult(r);
+        results.push_back(std::move(r));
+    };
+
+    if (selected("step")) {
+        for (int n : sizes)
+            for (int sides : shapes)
+                for (int sub : subSteps)
+                    for (int t : threads)
+                        add(benchStep({n, sides, t}, sub, repeats, steps, verbose));
+    }
+    if (selected("manage_particles")) add(benchManageParticles({2000, 0, 1}, calls, verbose));
+    if (selected("arch_raycast"))     add(benchArchRaycast({2000, 0, 1}, calls / 2, verbose));
+    if (selected("create_particles")) {
+        for (int n : sizes)
+            for (int sides : shapes)
+                add(benchCreateParticles({n, sides, 1}, repeats, verbose));
+    }
+    if (selected("frame_writer")) {
+        add(benchFrameWriter({2000, 0, 1}, 0, calls, verbose));
+        add(benchFrameWriter({2000, 0, 1}, 1, calls, verbose));
+    }
+    if (selected("multirate")) {
+        for (int k : {1, 4})
+            add(benchMultiRate({2000, 0, 1}, k, repeats, steps * 4, verbose));
+    }
+
+    std::error_code ec;
+    fs::remove_all(SCRATCH_DIR, ec);
+
+    if (!writeJson(output, commit, repeats, results)) {
+        std::cerr << "Error: no se pudo escribir " << output << "\n";
+        return 1;
+    }
+    std::cout << results.size() << " casos -> " << output << "\n";
+    return 0;
+}